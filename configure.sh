@@ -12,6 +12,8 @@ where <option> is one of the following
   -h      print this command line option summary
   -g      compile with debugging support
   -c      compile with assertion checking (default with '-g')
+  -t      compile with event tracing ('-trace <file>')
+  -p      compile with hardware performance counters (Linux only)
 
 and for debugging and testing you can also use
 
@@ -21,6 +23,8 @@ EOF
 }
 debug=no
 check=undefined
+trace=no
+perf=no
 test
 while [ $# -gt 0 ]
 do
@@ -28,6 +32,8 @@ do
     -h|--help) usage; exit 0;;
     -c) check=yes;;
     -g) debug=yes;;
+    -t) trace=yes;;
+    -p) perf=yes;;
     -*) die "invalid option '$1' (try '-h')";;
   esac
   shift
@@ -39,7 +45,7 @@ elif [ $check = undefined ]
 then
   check=no
 fi
-CFLAGS="-Wall -Wextra -std=c++11"
+CFLAGS="-Wall -Wextra -std=c++11 -pthread"
 if [ $debug = yes ]
 then
   CFLAGS="$CFLAGS -g3"
@@ -47,6 +53,7 @@ else
   CFLAGS="$CFLAGS -O3"
 fi
 [ $check = no ] && CFLAGS="$CFLAGS -DNDEBUG"
+[ $trace = yes ] && CFLAGS="$CFLAGS -DAMULETTRACE"
 [ "$CC" = "" ] && CC=g++
 
 
@@ -91,6 +98,27 @@ EOF
     [ $? = 42 ] && CFLAGS="$CFLAGS -DHAVEUNLOCKEDIO"
   fi
   rm -f $tmp*
+  if [ $perf = yes ]
+  then
+cat >$tmp.c <<EOF
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+int main () {
+  struct perf_event_attr attr;
+  memset (&attr, 0, sizeof attr);
+  attr.size = sizeof attr;
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_CPU_CYCLES;
+  return syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0) < 0;
+}
+EOF
+    $CC $CFLAGS $tmp.c -o $tmp.exe 1>/dev/null 2>/dev/null || \
+      die "can not compile 'perf_event_open' (required by '-p')"
+    CFLAGS="$CFLAGS -DAMULETPERF"
+    rm -f $tmp*
+  fi
 fi
 AIGLIB="../aiger/aiger.o"
 
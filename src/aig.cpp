@@ -9,16 +9,16 @@
 #include "aig.h"
 /*------------------------------------------------------------------------*/
 // Global Variables
-unsigned M, NN;
-unsigned a0, al, ainc;
-unsigned b0, bl, binc;
+thread_local unsigned M, NN;
+thread_local unsigned a0, al, ainc;
+thread_local unsigned b0, bl, binc;
 
-aiger * rewritten;
-aiger * miter;
+thread_local aiger * rewritten;
+thread_local aiger * miter;
 /*------------------------------------------------------------------------*/
 // Local Variables
 
-aiger * model;   // /< aiger* object, used for storing the given AIG graph
+static thread_local aiger * model;   // /< aiger* object, used for storing the given AIG graph
 /*------------------------------------------------------------------------*/
 void init_aig_substitution() {
   rewritten = aiger_init();
@@ -28,6 +28,7 @@ void init_aig_substitution() {
 void reset_aig_substitution() {
   aiger_reset(rewritten);
   aiger_reset(miter);
+  rewritten = miter = 0;
 }
 /*------------------------------------------------------------------------*/
 void init_aig_parsing() {
@@ -36,12 +37,47 @@ void init_aig_parsing() {
 /*------------------------------------------------------------------------*/
 void reset_aig_parsing() {
   aiger_reset(model);
+  model = 0;
 }
 /*------------------------------------------------------------------------*/
+aiger * get_model() { return model; }
+
+void set_model(aiger * m) { model = m; }
+/*------------------------------------------------------------------------*/
 const char * aiger_open_and_read_to_model(const char * input_name) {
   return aiger_open_and_read_from_file(model, input_name);
 }
 /*------------------------------------------------------------------------*/
+// / read position in a buffer, used as state of aiger_read_generic
+struct Aiger_buffer_state {
+  const char * pos, * end;
+};
+
+static int aiger_buffer_get(void * state) {
+  Aiger_buffer_state * buf = reinterpret_cast<Aiger_buffer_state*>(state);
+  if (buf->pos == buf->end) return EOF;
+  return static_cast<unsigned char>(*buf->pos++);
+}
+
+const char * aiger_read_buffer_to_model(const char * buffer, size_t size) {
+  Aiger_buffer_state state = {buffer, buffer + size};
+  return aiger_read_generic(model, &state, aiger_buffer_get);
+}
+/*------------------------------------------------------------------------*/
+const char * aiger_copy_to_model(const aiger * aig) {
+  for (unsigned i = 0; i < aig->num_inputs; i++)
+    aiger_add_input(model, aig->inputs[i].lit, aig->inputs[i].name);
+  for (unsigned i = 0; i < aig->num_latches; i++)
+    aiger_add_latch(model, aig->latches[i].lit, aig->latches[i].next,
+      aig->latches[i].name);
+  for (unsigned i = 0; i < aig->num_outputs; i++)
+    aiger_add_output(model, aig->outputs[i].lit, aig->outputs[i].name);
+  for (unsigned i = 0; i < aig->num_ands; i++)
+    aiger_add_and(model, aig->ands[i].lhs, aig->ands[i].rhs0,
+      aig->ands[i].rhs1);
+  return aiger_check(model);
+}
+/*------------------------------------------------------------------------*/
 
 bool is_model_input(unsigned val) {
   return aiger_is_input(model, val);
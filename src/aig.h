@@ -18,25 +18,25 @@ extern "C" {
 }
 /*------------------------------------------------------------------------*/
 
-extern unsigned M;   // /< stores the maximum variable num of the input AIG
-extern unsigned NN;  // /< stores the number of inputs of the input AIG
+extern thread_local unsigned M;   // /< stores the maximum variable num of the input AIG
+extern thread_local unsigned NN;  // /< stores the number of inputs of the input AIG
 
-extern unsigned a0;    // /< input value for the LSB of input vector A
-extern unsigned al;    // /< input value for the MSB of input vector A
-extern unsigned ainc;  // /< distance between aiger values of A
+extern thread_local unsigned a0;    // /< input value for the LSB of input vector A
+extern thread_local unsigned al;    // /< input value for the MSB of input vector A
+extern thread_local unsigned ainc;  // /< distance between aiger values of A
 
-extern unsigned b0;    // /< input value for the LSB of input vector B
-extern unsigned bl;    // /< input value for the MSB of input vector B
-extern unsigned binc;  // /< distance between aiger values of B
+extern thread_local unsigned b0;    // /< input value for the LSB of input vector B
+extern thread_local unsigned bl;    // /< input value for the MSB of input vector B
+extern thread_local unsigned binc;  // /< distance between aiger values of B
 
 
 // / aiger * storing the generated miter during '-substitution'
 // / Will be transformed into CNF and printed to the provided output file.
-extern aiger * miter;
+extern thread_local aiger * miter;
 
 // / aiger * storing the generated rewritten AIG during '-substitution'
 // / Will be printed to the provided output file.
-extern aiger * rewritten;
+extern thread_local aiger * rewritten;
 
 /*------------------------------------------------------------------------*/
 
@@ -61,6 +61,21 @@ void reset_aig_substitution();
     Resets the 'aiger* model', which is local to aig.cpp
 */
 void reset_aig_parsing();
+
+/**
+    Returns the 'aiger* model' of the calling thread
+
+    @return aiger*
+*/
+aiger * get_model();
+
+/**
+    Replaces the 'aiger* model' of the calling thread, without freeing the
+    previous one
+
+    @param m aiger*
+*/
+void set_model(aiger * m);
 /*------------------------------------------------------------------------*/
 // Functions that interfer with aiger* model, that is used to store the
 // input AIG.
@@ -76,6 +91,28 @@ void reset_aig_parsing();
 */
 const char * aiger_open_and_read_to_model(const char * input_name);
 
+/**
+    Reads an AIG in AIGER format from a memory buffer to 'aiger* model'
+
+    @param buffer const char* contents of an AIGER file
+    @param size size_t number of bytes in buffer
+
+    @return const char*, defining a possible error message
+            Equal to zero if everything went right.
+*/
+const char * aiger_read_buffer_to_model(const char * buffer, size_t size);
+
+/**
+    Copies the inputs, latches, outputs and AND gates of an AIG to
+    'aiger* model', literals and symbols are kept
+
+    @param aig const aiger* AIG to be copied
+
+    @return const char*, defining a possible error message
+            Equal to zero if everything went right.
+*/
+const char * aiger_copy_to_model(const aiger * aig);
+
 /**
     Checks whether the given value corrensponds to an input of 'aiger* model'
 
@@ -13,19 +13,23 @@ static const char * USAGE =
 "\n"
 "### USAGE ###\n"
 "usage : amulet2 <mode> <input.aig> <output files> [<option> ...] \n"
+"        amulet2 -batch <list|dir> [<option> ...] \n"
+"        amulet2 -serve <socket> [<option> ...] \n"
 "\n"
 "Depending on the <mode> the <output files> and <options> have to be set:"
 "\n"
 "\n"
 "<mode> = -substitute:\n"
 "    <output files> =  2 output files passed in the following order \n"
-"      <out.cnf>:        CNF miter for correctness of adder substitution \n"
+"      <out.cnf>:        CNF miter for correctness of adder substitution(gzipped for *.gz)\n"
 "      <out.aig>:        rewritten aiger is stored in this file \n"
 "\n"
 "    <option> = the following options are available \n"
 "      -h | --help       print this command line summary \n"
 "      -v<1,2,3,4>       different levels of verbosity(see below) \n"
 "      -signed           option for non-negative integer multipliers \n"
+"      -simulate         simulate the miter and merge equivalent gates before writing the CNF\n"
+"      -profile <file>   write time and memory per phase to file(JSON, or CSV for *.csv)\n"
 "\n"
 "\n"
 "<mode> = -verify:\n"
@@ -36,6 +40,23 @@ static const char * USAGE =
 "       -v<1,2,3,4>           different levels of verbosity(default -v1) \n"
 "       -signed               option for non-negative integer multipliers \n"
 "       -no-counter-examples  do not generate and write counter examples\n"
+"       -counter-examples <n> write up to n counter examples validated by simulation\n"
+"       -simulate             simulate random and structured patterns before slicing\n"
+"       -threads <n>          generate all gate constraints upfront using n threads\n"
+"       -profile <file>       write time and memory per phase and slice to file(JSON, or CSV for *.csv)\n"
+"       -cache <dir>          reuse results of structurally identical designs cached in dir\n"
+"       -checkpoint <file>    periodically save the state of the reduction to file\n"
+"       -checkpoint-interval <s> seconds between two checkpoints(default 60)\n"
+"       -resume <file>        continue the reduction from the checkpoint in file\n"
+"       -save-remainders <file> save the AIG and the remainder after each slice to file\n"
+"       -incremental <file>   reduce only the slices changed w.r.t. the remainders saved in file\n"
+"       -spill <MB>           keep the remainder on disk once it exceeds MB megabytes\n"
+"       -max-mem <MB>         abort the reduction once MB megabytes are used\n"
+"       -max-time <s>         abort the reduction after s seconds of process time\n"
+"       -progress <s>         report the progress of the reduction every s seconds\n"
+#ifdef AMULETTRACE
+"       -trace <file>         write a timeline of the phases and slices to file(trace event format)\n"
+#endif
 "     \n"
 "     \n"
 "<mode> = -certify:\n"
@@ -49,14 +70,41 @@ static const char * USAGE =
 "       -v<1,2,3,4>      different levels of verbosity(default -v1) \n"
 "       -signed          option for non-negative integer multipliers \n"
 "       -no-counter-examples  do not generate and write counter examples\n"
+"       -counter-examples <n> write up to n counter examples validated by simulation\n"
+"       -simulate        simulate random and structured patterns before slicing\n"
+"       -threads <n>     generate all gate constraints upfront using n threads\n"
+"       -profile <file>  write time and memory per phase and slice to file(JSON, or CSV for *.csv)\n"
+"       -cache <dir>     reuse results of structurally identical designs cached in dir\n"
+"       -max-mem <MB>    abort the reduction once MB megabytes are used\n"
+"       -max-time <s>    abort the reduction after s seconds of process time\n"
+"       -progress <s>    report the progress of the reduction every s seconds\n"
 "\n"
 "       -p1          expanded proof \n"
 "       -p2          middle condensed proof(some linear combinations occur, default)\n"
-"       -p3          condensed proof(one single linear combination)\n";
+"       -p3          condensed proof(one single linear combination)\n"
+"\n"
+"\n"
+"<mode> = -batch <list|dir>:\n"
+"    verifies all *.aig and *.aag files of the directory, or all files of the\n"
+"    list file(one per line, '#' starts a comment), in one process\n"
+"    <output files> =  no output files are required \n"
+"     \n "
+"    <option> = the options of -verify except -profile and additionally \n"
+"       -jobs <n>             verify n designs concurrently in worker threads\n"
+"\n"
+"\n"
+"<mode> = -serve <socket>:\n"
+"    keeps running and answers verify and certify requests with AIG payloads\n"
+"    on the Unix domain socket until a 'shutdown' request, see src/server.h\n"
+"    <output files> =  no output files are required \n"
+"     \n "
+"    <option> = the options of -verify except -profile and additionally \n"
+"       -jobs <n>             serve n connections concurrently in worker threads\n";
 /*------------------------------------------------------------------------*/
-#include "parser.h"
-#include "substitution_engine.h"
-#include "polynomial_solver.h"
+#include "batch.h"
+#include "perf_counters.h"
+#include "server.h"
+#include "trace.h"
 /*------------------------------------------------------------------------*/
 // / Name of the input file
 static const char * input_name = 0;
@@ -74,7 +122,9 @@ static const char * output_name2 = 0;
 // / Name of third output file. Stores the specification in '-certify'.
 static const char * output_name3 = 0;
 
-// / Selected mode, '-substitute' = 1, '-verify' = 2, '-certify' = 3
+// / \brief
+// / Selected mode, '-substitute' = 1, '-verify' = 2, '-certify' = 3,
+// / '-batch' = 4, '-serve' = 5
 static int mode;
 /*------------------------------------------------------------------------*/
 // ERROR CODES:
@@ -87,19 +137,14 @@ static int err_proof_form = 13; // too many proof formats selected
 
 /*------------------------------------------------------------------------*/
 /**
-    Calls the deallocaters of the involved data types
+    Calls the deallocaters of the data types that belong to the main thread,
+    the design itself is freed by its verification context
     @see reset_all_signal_handlers()
-    @see delete_gates()
-    @see deallocate_terms()
     @see deallocate_mstack()
-    @see clear_mpz()
 */
 static void reset_all() {
   reset_all_signal_handlers();
-  delete_gates();
-  deallocate_terms();
   deallocate_mstack();
-  clear_mpz();
 }
 /*------------------------------------------------------------------------*/
 /**
@@ -146,6 +191,24 @@ int main(int argc, char ** argv) {
       } else {
         die(err_mode_sel, "mode has alreday been selected(try '-h')");
       }
+    } else if (!strcmp(argv[i], "-batch")) {
+      if (!mode) {
+        msg("selected mode: batch verification");
+        mode = 4;
+      } else {
+        die(err_mode_sel, "mode has alreday been selected(try '-h')");
+      }
+    } else if (!strcmp(argv[i], "-serve")) {
+      if (!mode) {
+        msg("selected mode: verification server");
+        mode = 5;
+      } else {
+        die(err_mode_sel, "mode has alreday been selected(try '-h')");
+      }
+    } else if (!strcmp(argv[i], "-jobs")) {
+      if (++i == argc || atoi(argv[i]) < 1)
+        die(err_wrong_arg, "'-jobs' expects a positive number(try '-h')");
+      batch_jobs = atoi(argv[i]);
     } else if (!strcmp(argv[i], "-p1")) {
       if (proof) die(err_proof_form, "too many proof formats selected(try '-h')");
       proof = 1;
@@ -157,8 +220,75 @@ int main(int argc, char ** argv) {
       proof = 3;
     } else if (!strcmp(argv[i], "-signed")) {
       signed_mult = 1;
+    } else if (!strcmp(argv[i], "-simulate")) {
+      miter_simulation = 1;
+      multiplier_simulation = 1;
     } else if (!strcmp(argv[i], "-no-counter-examples")) {
       gen_witness = 0;
+    } else if (!strcmp(argv[i], "-counter-examples")) {
+      if (++i == argc || atoi(argv[i]) < 1)
+        die(err_wrong_arg,
+          "'-counter-examples' expects a positive number(try '-h')");
+      max_counter_examples = atoi(argv[i]);
+    } else if (!strcmp(argv[i], "-threads")) {
+      if (++i == argc || atoi(argv[i]) < 1)
+        die(err_wrong_arg, "'-threads' expects a positive number(try '-h')");
+      num_threads = atoi(argv[i]);
+    } else if (!strcmp(argv[i], "-checkpoint")) {
+      if (++i == argc)
+        die(err_wrong_arg, "'-checkpoint' expects a file name(try '-h')");
+      checkpoint_name = argv[i];
+    } else if (!strcmp(argv[i], "-checkpoint-interval")) {
+      if (++i == argc || atof(argv[i]) < 0)
+        die(err_wrong_arg,
+          "'-checkpoint-interval' expects a number of seconds(try '-h')");
+      checkpoint_interval = atof(argv[i]);
+    } else if (!strcmp(argv[i], "-resume")) {
+      if (++i == argc)
+        die(err_wrong_arg, "'-resume' expects a file name(try '-h')");
+      resume_name = argv[i];
+    } else if (!strcmp(argv[i], "-save-remainders")) {
+      if (++i == argc)
+        die(err_wrong_arg, "'-save-remainders' expects a file name(try '-h')");
+      save_remainders_name = argv[i];
+    } else if (!strcmp(argv[i], "-incremental")) {
+      if (++i == argc)
+        die(err_wrong_arg, "'-incremental' expects a file name(try '-h')");
+      incremental_name = argv[i];
+    } else if (!strcmp(argv[i], "-spill")) {
+      if (++i == argc || atof(argv[i]) <= 0)
+        die(err_wrong_arg, "'-spill' expects a positive number of MB(try '-h')");
+      spill_memory = atof(argv[i]);
+    } else if (!strcmp(argv[i], "-max-mem")) {
+      if (++i == argc || atof(argv[i]) <= 0)
+        die(err_wrong_arg, "'-max-mem' expects a positive number of MB(try '-h')");
+      max_memory = atof(argv[i]);
+    } else if (!strcmp(argv[i], "-max-time")) {
+      if (++i == argc || atof(argv[i]) <= 0)
+        die(err_wrong_arg,
+          "'-max-time' expects a positive number of seconds(try '-h')");
+      max_time = atof(argv[i]);
+    } else if (!strcmp(argv[i], "-progress")) {
+      if (++i == argc || atof(argv[i]) <= 0)
+        die(err_wrong_arg,
+          "'-progress' expects a positive number of seconds(try '-h')");
+      progress_interval = atof(argv[i]);
+    } else if (!strcmp(argv[i], "-cache")) {
+      if (++i == argc)
+        die(err_wrong_arg, "'-cache' expects a directory(try '-h')");
+      cache_dir = argv[i];
+    } else if (!strcmp(argv[i], "-profile")) {
+      if (++i == argc)
+        die(err_wrong_arg, "'-profile' expects a file name(try '-h')");
+      profile_name = argv[i];
+    } else if (!strcmp(argv[i], "-trace")) {
+      if (++i == argc)
+        die(err_wrong_arg, "'-trace' expects a file name(try '-h')");
+#ifndef AMULETTRACE
+      die(err_wrong_arg,
+        "'-trace' needs tracing support, reconfigure with './configure.sh -t'");
+#endif
+      trace_name = argv[i];
     } else if (output_name3) {
       die(err_wrong_arg, "too many arguments '%s', '%s', '%s', '%s' and '%s'(try '-h')",
         input_name, output_name1, output_name2, output_name3, argv[i]);
@@ -172,6 +302,25 @@ int main(int argc, char ** argv) {
 
   if (!mode) die(err_mode_sel, "select mode(try -h for more information)");
   if (!input_name)  die(err_no_file, "no input file given(try '-h')");
+  if ((checkpoint_name || resume_name) && mode != 2)
+    die(err_wrong_arg, "'-checkpoint' and '-resume' are only possible in -verify");
+  if ((save_remainders_name || incremental_name) && mode != 2)
+    die(err_wrong_arg,
+      "'-save-remainders' and '-incremental' are only possible in -verify");
+  if (resume_name && incremental_name)
+    die(err_wrong_arg, "'-resume' and '-incremental' can not be combined");
+  if ((max_memory || max_time) && mode != 2 && mode != 3)
+    die(err_wrong_arg,
+      "'-max-mem' and '-max-time' are only possible in -verify and -certify");
+  if (profile_name && (mode == 4 || mode == 5))
+    die(err_wrong_arg, "'-profile' is not possible in -batch and -serve");
+  if (progress_interval && mode != 2 && mode != 3)
+    die(err_wrong_arg, "'-progress' is only possible in -verify and -certify");
+  if (spill_memory && mode != 2)
+    die(err_wrong_arg, "'-spill' is only possible in -verify");
+  if (spill_memory && (checkpoint_name || save_remainders_name))
+    die(err_wrong_arg,
+      "'-spill' can not be combined with '-checkpoint' or '-save-remainders'");
   if (mode == 1) {
     if (output_name3)
       die(err_wrong_arg, "too many arguments '%s', '%s', '%s' and '%s'(try '-h')",
@@ -182,7 +331,7 @@ int main(int argc, char ** argv) {
       msg("and will be ignored");
     }
     proof = 0;
-  } else if (mode == 2) {
+  } else if (mode == 2 || mode == 4 || mode == 5) {
     if (output_name1) die(err_wrong_arg, "too many arguments(try '-h')");
     if (proof) {
       msg("option -p1, -p2 or -p3 are only possible in -certify");
@@ -199,22 +348,36 @@ int main(int argc, char ** argv) {
   }
 
   init_all_signal_handers();
-  init_nonces();
+  init_profiler();
+  init_perf_counters();
 
-  parse_aig(input_name);
+  Verification_options options = current_options();
   bool res;
-  if (mode == 1) {
-    init_gate_substitution();
-    res = substitution(output_name1, output_name2);
-  } else {
-    init_gates_verify();
-    res = verify(input_name, output_name1, output_name2, output_name3, mode == 3);
+  try {
+    if (mode == 4) {
+      res = verify_batch(input_name, options);
+    } else if (mode == 5) {
+      serve(input_name, options, batch_jobs);
+      res = 0;
+    } else {
+      Verification_context context(options);
+      context.parse(input_name);
+      if (mode == 1)
+        res = context.substitution(output_name1, output_name2);
+      else if (mode == 2)
+        res = context.verify();
+      else
+        res = context.certify(output_name1, output_name2, output_name3);
+    }
+  } catch (const Amulet_error & e) {
+    return e.get_error_code();
   }
 
-  reset_aig_parsing();
   reset_all();
 
   reset_time = process_time();
+  write_profile();
+  write_trace();
   print_statistics(mode);
 
   return res;
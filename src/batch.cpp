@@ -0,0 +1,185 @@
+/*------------------------------------------------------------------------*/
+/*! \file batch.cpp
+    \brief verification of many AIGs in one process
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batch.h"
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_batch = 121;  // cannot read batch list or directory
+/*------------------------------------------------------------------------*/
+
+unsigned batch_jobs = 1;
+
+/*------------------------------------------------------------------------*/
+// Result of a single design in the batch
+enum Batch_result { batch_incorrect, batch_correct, batch_failed };
+
+static const char * batch_result_name(Batch_result r) {
+  if (r == batch_correct) return "CORRECT";
+  else if (r == batch_incorrect) return "INCORRECT";
+  else
+    return "FAILED";
+}
+
+/*------------------------------------------------------------------------*/
+
+static bool has_aig_suffix(const std::string & name) {
+  size_t len = name.size();
+  if (len < 4) return 0;
+  std::string suffix = name.substr(len - 4);
+  return suffix == ".aig" || suffix == ".aag";
+}
+
+/*------------------------------------------------------------------------*/
+// Collects the designs of the directory or list file `name`
+static std::vector<std::string> collect_designs(const char * name) {
+  std::vector<std::string> designs;
+  struct stat st;
+  if (stat(name, &st))
+    die(err_batch, "can not access batch '%s'", name);
+
+  if (S_ISDIR(st.st_mode)) {
+    DIR * dir = opendir(name);
+    if (!dir) die(err_batch, "can not open directory '%s'", name);
+    std::string prefix = name;
+    if (prefix.back() != '/') prefix += '/';
+    while (struct dirent * e = readdir(dir)) {
+      if (has_aig_suffix(e->d_name)) designs.push_back(prefix + e->d_name);
+    }
+    closedir(dir);
+    std::sort(designs.begin(), designs.end());
+  } else {
+    FILE * file = fopen(name, "r");
+    if (!file) die(err_batch, "can not read batch list '%s'", name);
+    char line[4096];
+    while (fgets(line, sizeof line, file)) {
+      std::string s = line;
+      size_t first = s.find_first_not_of(" \t\r\n");
+      if (first == std::string::npos || s[first] == '#') continue;
+      size_t last = s.find_last_not_of(" \t\r\n");
+      designs.push_back(s.substr(first, last - first + 1));
+    }
+    fclose(file);
+  }
+
+  if (designs.empty()) die(err_batch, "no designs found in '%s'", name);
+  return designs;
+}
+
+/*------------------------------------------------------------------------*/
+// Parses and verifies a single design in the given context, errors are
+// reported as failure
+static Batch_result verify_design(
+  Verification_context & context, const char * design) {
+  try {
+    context.parse(design);
+    return context.verify() ? batch_correct : batch_incorrect;
+  } catch (const Amulet_error &) {
+    return batch_failed;
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+static void print_design_result(
+  const std::string & design, Batch_result r, double time) {
+  msg("batch %-9s %10.2f seconds  %s",
+    batch_result_name(r), time, design.c_str());
+}
+
+/*------------------------------------------------------------------------*/
+// Verifies the designs one after the other on the calling thread
+static void run_sequential(
+  const std::vector<std::string> & designs,
+  const Verification_options & options,
+  std::vector<Batch_result> & results) {
+  Verification_context context(options);
+  for (size_t i = 0; i < designs.size(); i++) {
+    const char * design = designs[i].c_str();
+    double start = wall_clock_time();
+    msg("");
+    msg("batch design %zu/%zu: '%s'", i + 1, designs.size(), design);
+    results[i] = verify_design(context, design);
+    print_design_result(designs[i], results[i], wall_clock_time() - start);
+  }
+}
+
+/*------------------------------------------------------------------------*/
+// Worker thread, takes the next design until all designs are taken
+static void batch_worker(
+  const std::vector<std::string> * designs,
+  const Verification_options * options,
+  std::atomic<size_t> * next,
+  std::vector<Batch_result> * results) {
+  Verification_context context(*options);
+  size_t i;
+  while ((i = (*next)++) < designs->size()) {
+    double start = wall_clock_time();
+    (*results)[i] = verify_design(context, (*designs)[i].c_str());
+    print_design_result(
+      (*designs)[i], (*results)[i], wall_clock_time() - start);
+  }
+  deallocate_mstack();
+}
+
+/*------------------------------------------------------------------------*/
+// Verifies the designs concurrently in `batch_jobs` worker threads
+static void run_parallel(
+  const std::vector<std::string> & designs,
+  const Verification_options & options,
+  std::vector<Batch_result> & results) {
+  Verification_options quiet_options = options;
+  quiet_options.verbose = 0;
+  quiet_options.quiet = 1;
+
+  std::atomic<size_t> next(0);
+  size_t jobs = std::min<size_t>(batch_jobs, designs.size());
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < jobs; t++) {
+    workers.push_back(std::thread(
+      batch_worker, &designs, &quiet_options, &next, &results));
+  }
+  for (size_t t = 0; t < jobs; t++) workers[t].join();
+}
+
+/*------------------------------------------------------------------------*/
+
+bool verify_batch(const char * name, const Verification_options & options) {
+  std::vector<std::string> designs = collect_designs(name);
+  std::vector<Batch_result> results(designs.size(), batch_failed);
+  msg("batch of %zu designs from '%s'", designs.size(), name);
+
+  if (batch_jobs > 1 && designs.size() > 1) {
+    msg("verifying with %u jobs", batch_jobs);
+    run_parallel(designs, options, results);
+  } else {
+    run_sequential(designs, options, results);
+  }
+
+  unsigned correct = 0, incorrect = 0, failed = 0;
+  for (const Batch_result & r : results) {
+    if (r == batch_correct) correct++;
+    else if (r == batch_incorrect) incorrect++;
+    else
+      failed++;
+  }
+
+  msg("");
+  msg("batch summary: %zu designs, %u correct, %u incorrect, %u failed",
+    designs.size(), correct, incorrect, failed);
+
+  return correct == designs.size();
+}
@@ -0,0 +1,38 @@
+/*------------------------------------------------------------------------*/
+/*! \file batch.h
+    \brief verification of many AIGs in one process
+
+  The designs are given either as a directory, of which all '*.aig' and
+  '*.aag' files are verified in alphabetical order, or as a list file with
+  one file name per line, where empty lines and lines starting with '#' are
+  ignored. Every job verifies its designs one after the other in a single
+  verification context, which keeps its term table between the designs.
+
+  With more than one job the designs are verified concurrently by worker
+  threads, each owning a verification context. Their messages are
+  suppressed, only the result lines are printed.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_BATCH_H_
+#define AMULET2_SRC_BATCH_H_
+/*------------------------------------------------------------------------*/
+#include "verification_context.h"
+/*------------------------------------------------------------------------*/
+// / number of designs that are verified concurrently, default is 1
+extern unsigned batch_jobs;
+
+/**
+    Verifies all designs of the directory or list file and prints one
+    result line per design followed by a summary
+
+    @param name char * name of the directory or list file
+    @param options const Verification_options & used for all designs
+
+    @return true if all designs are correct multipliers
+*/
+bool verify_batch(const char * name, const Verification_options & options);
+
+#endif  // AMULET2_SRC_BATCH_H_
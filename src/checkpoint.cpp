@@ -0,0 +1,174 @@
+/*------------------------------------------------------------------------*/
+/*! \file checkpoint.cpp
+    \brief checkpoints of the reduction, which allow to resume an
+    interrupted verification
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "checkpoint.h"
+#include "result_cache.h"
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_checkpoint = 161;  // cannot write checkpoint
+static int err_resume     = 162;  // cannot read checkpoint or wrong design
+/*------------------------------------------------------------------------*/
+// Global variables
+thread_local const char * checkpoint_name = 0;
+thread_local const char * resume_name = 0;
+thread_local double checkpoint_interval = 60;
+
+// / time of the last checkpoint, or of the start of the reduction
+static thread_local double last_checkpoint;
+
+// / true if a checkpoint has been written in this reduction
+static thread_local bool checkpoint_written;
+
+static const char checkpoint_magic[8] = {'A', 'M', 'U', 'L', 'E', 'T', 'C', '1'};
+/*------------------------------------------------------------------------*/
+
+void init_checkpoints() {
+  last_checkpoint = wall_clock_time();
+  checkpoint_written = 0;
+}
+
+/*------------------------------------------------------------------------*/
+// Index of the gate of v in gates
+static uint32_t gate_index(const Var * v) {
+  int num = v->get_num();
+  uint32_t res = num > 0 ? num/2 - 1 : M - 1 - num;
+  assert(res < num_gates && gates[res]->get_var() == v);
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+template<class T>
+static bool write_value(FILE * file, T val) {
+  return fwrite(&val, sizeof val, 1, file) == 1;
+}
+
+template<class T>
+static bool read_value(FILE * file, T & val) {
+  return fread(&val, sizeof val, 1, file) == 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+bool write_monomial(FILE * file, const Monomial * m) {
+  bool ok = mpz_out_raw(file, m->coeff) != 0;
+  const Term * t = m->get_term();
+  ok = ok && write_value<uint32_t>(file, t ? t->size() : 0);
+  for (; ok && t; t = t->get_rest())
+    ok = write_value<uint32_t>(file, gate_index(t->get_var()));
+  return ok;
+}
+
+/*------------------------------------------------------------------------*/
+
+Monomial * read_monomial(FILE * file) {
+  mpz_t coeff;
+  mpz_init(coeff);
+  uint32_t len, idx;
+  bool ok = mpz_inp_raw(coeff, file) != 0 && read_value(file, len);
+  for (uint32_t j = 0; ok && j < len; j++) {
+    ok = read_value(file, idx) && idx < num_gates;
+    if (ok) add_to_vstack(gates[idx]->get_var());
+  }
+  Term * t = build_term_from_stack();
+  Monomial * res = 0;
+  if (ok) res = new Monomial(coeff, t);
+  else if (t)
+    deallocate_term(t);
+  mpz_clear(coeff);
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+void checkpoint_reduction(int slice, const Polynomial * rem) {
+  if (!checkpoint_name || !rem || proof) return;
+  double now = wall_clock_time();
+  if (now - last_checkpoint < checkpoint_interval) return;
+
+  std::string tmp = std::string(checkpoint_name) + ".tmp";
+  FILE * file = fopen(tmp.c_str(), "w");
+  if (!file) die(err_checkpoint, "can not write checkpoint '%s'", tmp.c_str());
+
+  std::string fingerprint = structural_fingerprint();
+  bool ok = fwrite(checkpoint_magic, sizeof checkpoint_magic, 1, file) == 1;
+  ok = ok && fwrite(fingerprint.data(), fingerprint.size(), 1, file) == 1;
+  ok = ok && write_value<uint8_t>(file, signed_mult);
+  ok = ok && write_value<int32_t>(file, slice);
+  ok = ok && write_value<uint64_t>(file, rem->size());
+  for (size_t i = 0; ok && i < rem->size(); i++)
+    ok = write_monomial(file, rem->get_mon(i));
+  if (fclose(file) || !ok || rename(tmp.c_str(), checkpoint_name)) {
+    unlink(tmp.c_str());
+    die(err_checkpoint, "can not write checkpoint '%s'", checkpoint_name);
+  }
+
+  last_checkpoint = wall_clock_time();
+  checkpoint_written = 1;
+  msg("checkpoint before slice %i written to '%s' in %.2f seconds",
+    slice, checkpoint_name, last_checkpoint - now);
+}
+
+/*------------------------------------------------------------------------*/
+
+Polynomial * resume_reduction(int & slice) {
+  FILE * file = fopen(resume_name, "r");
+  if (!file) die(err_resume, "can not read checkpoint '%s'", resume_name);
+
+  char magic[sizeof checkpoint_magic];
+  std::string fingerprint = structural_fingerprint();
+  std::string stored(fingerprint.size(), ' ');
+  uint8_t sign;
+  int32_t first;
+  uint64_t size;
+  bool ok = fread(magic, sizeof magic, 1, file) == 1 &&
+    !memcmp(magic, checkpoint_magic, sizeof magic);
+  if (!ok) die(err_resume, "'%s' is not a checkpoint", resume_name);
+
+  ok = fread(&stored[0], stored.size(), 1, file) == 1 &&
+    read_value(file, sign) && read_value(file, first) &&
+    read_value(file, size);
+  if (!ok) die(err_resume, "truncated checkpoint '%s'", resume_name);
+  if (stored != fingerprint || sign != signed_mult)
+    die(err_resume, "checkpoint '%s' belongs to a different design or mode",
+      resume_name);
+  if (first < 0 || first >= static_cast<int32_t>(NN))
+    die(err_resume, "invalid slice %i in checkpoint '%s'", first, resume_name);
+
+  for (uint64_t i = 0; ok && i < size; i++) {
+    Monomial * m = read_monomial(file);
+    if (m) push_mstack_end(m);
+    else
+      ok = 0;
+  }
+  fclose(file);
+  if (!ok) {
+    Polynomial * p = build_poly();
+    delete(p);
+    die(err_resume, "truncated checkpoint '%s'", resume_name);
+  }
+
+  slice = first;
+  msg("resuming from checkpoint '%s' before slice %i with %zu monomials",
+    resume_name, slice, static_cast<size_t>(size));
+  return build_poly();
+}
+
+/*------------------------------------------------------------------------*/
+
+void finish_checkpoints() {
+  if (checkpoint_written) unlink(checkpoint_name);
+  checkpoint_written = 0;
+}
@@ -0,0 +1,90 @@
+/*------------------------------------------------------------------------*/
+/*! \file checkpoint.h
+    \brief checkpoints of the reduction, which allow to resume an
+    interrupted verification
+
+  Before reducing by a slice, reduce writes the number of the slice and the
+  current remainder to the checkpoint file, if the last checkpoint is
+  older than checkpoint_interval seconds. The checkpoint is written to a
+  temporary file first and renamed, so an interrupted write keeps the
+  previous checkpoint.
+
+  Everything before the reduction (parsing, slicing and elimination) is
+  deterministic and repeated on resume, which also regenerates the gate
+  constraints of the remaining slices. The checkpoint therefore only
+  contains the structural fingerprint of the AIG, the slice and the
+  remainder, whose variables are stored as gate indices. The format is
+  binary in native byte order.
+
+  Checkpoints are only supported in '-verify', since in '-certify' the
+  proof file is written while reducing.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_CHECKPOINT_H_
+#define AMULET2_SRC_CHECKPOINT_H_
+/*------------------------------------------------------------------------*/
+#include "polynomial.h"
+/*------------------------------------------------------------------------*/
+// / Name of the checkpoint file, checkpoints are disabled if 0
+extern thread_local const char * checkpoint_name;
+
+// / Name of the checkpoint to resume from, 0 if not resuming
+extern thread_local const char * resume_name;
+
+// / Minimal number of seconds between two checkpoints
+extern thread_local double checkpoint_interval;
+
+/**
+    Writes the monomial m in the binary format of the checkpoints, the
+    variables are stored as gate indices
+
+    @param file FILE*
+    @param m const Monomial*
+
+    @return false if writing failed
+*/
+bool write_monomial(FILE * file, const Monomial * m);
+
+/**
+    Reads a monomial written by write_monomial
+
+    @param file FILE*
+
+    @return Monomial*, 0 if the file is truncated or corrupt
+*/
+Monomial * read_monomial(FILE * file);
+
+/**
+    Starts the clock of the checkpoint interval
+*/
+void init_checkpoints();
+
+/**
+    Writes the checkpoint if checkpoint_name is set and the interval has
+    passed
+
+    @param slice integer, slice that is reduced next
+    @param rem const Polynomial*, remainder after reducing the slices
+               above slice, may be 0
+*/
+void checkpoint_reduction(int slice, const Polynomial * rem);
+
+/**
+    Reads the checkpoint resume_name, which has to belong to the parsed
+    AIG
+
+    @param slice int &, set to the slice that is reduced next
+
+    @return Polynomial*, remainder after reducing the slices above slice
+*/
+Polynomial * resume_reduction(int & slice);
+
+/**
+    Deletes the checkpoint file after a completed reduction
+*/
+void finish_checkpoints();
+
+#endif  // AMULET2_SRC_CHECKPOINT_H_
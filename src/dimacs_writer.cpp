@@ -0,0 +1,102 @@
+/*------------------------------------------------------------------------*/
+/*! \file dimacs_writer.cpp
+    \brief buffered writer for CNFs in DIMACS format
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <stdlib.h>
+
+#include "dimacs_writer.h"
+#include "signal_statistics.h"
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_allocate = 211;  // failed to allocate the buffer
+/*------------------------------------------------------------------------*/
+
+Dimacs_writer::Dimacs_writer(FILE * _file) : file(_file) {
+  buffer = reinterpret_cast<char*>(malloc(buffer_size));
+  if (!buffer) die(err_allocate, "failed to allocate DIMACS buffer");
+}
+
+/*------------------------------------------------------------------------*/
+
+Dimacs_writer::~Dimacs_writer() {
+  flush();
+  free(buffer);
+}
+
+/*------------------------------------------------------------------------*/
+
+bool Dimacs_writer::flush() {
+  if (used && fwrite(buffer, 1, used, file) != used) ok = 0;
+  used = 0;
+  return ok && !fflush(file);
+}
+
+/*------------------------------------------------------------------------*/
+
+void Dimacs_writer::put_int(int lit) {
+  char tmp[12];
+  unsigned len = 0;
+  unsigned val = lit < 0 ? -static_cast<unsigned>(lit) : lit;
+  do {
+    tmp[len++] = '0' + val % 10;
+    val /= 10;
+  } while (val);
+  if (lit < 0) buffer[used++] = '-';
+  while (len) buffer[used++] = tmp[--len];
+}
+
+/*------------------------------------------------------------------------*/
+
+void Dimacs_writer::header(int vars, int clauses) {
+  if (buffer_size - used < 64) flush();
+  buffer[used++] = 'p';
+  buffer[used++] = ' ';
+  buffer[used++] = 'c';
+  buffer[used++] = 'n';
+  buffer[used++] = 'f';
+  buffer[used++] = ' ';
+  put_int(vars);
+  buffer[used++] = ' ';
+  put_int(clauses);
+  buffer[used++] = '\n';
+}
+
+/*------------------------------------------------------------------------*/
+
+void Dimacs_writer::clause(int a) {
+  if (buffer_size - used < 64) flush();
+  put_int(a);
+  buffer[used++] = ' ';
+  buffer[used++] = '0';
+  buffer[used++] = '\n';
+}
+
+/*------------------------------------------------------------------------*/
+
+void Dimacs_writer::clause(int a, int b) {
+  if (buffer_size - used < 64) flush();
+  put_int(a);
+  buffer[used++] = ' ';
+  put_int(b);
+  buffer[used++] = ' ';
+  buffer[used++] = '0';
+  buffer[used++] = '\n';
+}
+
+/*------------------------------------------------------------------------*/
+
+void Dimacs_writer::clause(int a, int b, int c) {
+  if (buffer_size - used < 64) flush();
+  put_int(a);
+  buffer[used++] = ' ';
+  put_int(b);
+  buffer[used++] = ' ';
+  put_int(c);
+  buffer[used++] = ' ';
+  buffer[used++] = '0';
+  buffer[used++] = '\n';
+}
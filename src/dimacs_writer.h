@@ -0,0 +1,100 @@
+/*------------------------------------------------------------------------*/
+/*! \file dimacs_writer.h
+    \brief buffered writer for CNFs in DIMACS format
+
+  Literals are formatted by hand into a large buffer, which is flushed with
+  a single fwrite whenever it is full, avoiding one fprintf per clause.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_DIMACS_WRITER_H_
+#define AMULET2_SRC_DIMACS_WRITER_H_
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+/*------------------------------------------------------------------------*/
+
+/** \class Dimacs_writer
+    Buffers the DIMACS output for a file
+*/
+class Dimacs_writer {
+  // / size of the output buffer
+  static const size_t buffer_size = 1 << 20;
+
+  // / file the buffer is flushed to
+  FILE * file;
+
+  // / output buffer
+  char * buffer;
+
+  // / number of used bytes in buffer
+  size_t used = 0;
+
+  // / false if writing to the file failed
+  bool ok = 1;
+
+  /**
+      Writes an integer to the buffer without flushing
+
+      @param lit integer
+  */
+  void put_int(int lit);
+
+ public:
+  /**
+      Constructor
+
+      @param _file FILE * output file
+  */
+  explicit Dimacs_writer(FILE * _file);
+
+  /**
+      Destructor, flushes the remaining buffer
+  */
+  ~Dimacs_writer();
+
+  Dimacs_writer(const Dimacs_writer &) = delete;
+  Dimacs_writer & operator=(const Dimacs_writer &) = delete;
+
+  /**
+      Writes the header line 'p cnf <vars> <clauses>'
+
+      @param vars integer number of variables
+      @param clauses integer number of clauses
+  */
+  void header(int vars, int clauses);
+
+  /**
+      Writes a unit clause
+
+      @param a integer literal
+  */
+  void clause(int a);
+
+  /**
+      Writes a binary clause
+
+      @param a integer literal
+      @param b integer literal
+  */
+  void clause(int a, int b);
+
+  /**
+      Writes a ternary clause
+
+      @param a integer literal
+      @param b integer literal
+      @param c integer literal
+  */
+  void clause(int a, int b, int c);
+
+  /**
+      Writes the buffer to the file
+
+      @return false if writing failed
+  */
+  bool flush();
+};
+
+#endif  // AMULET2_SRC_DIMACS_WRITER_H_
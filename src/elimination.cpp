@@ -10,12 +10,22 @@
 */
 /*------------------------------------------------------------------------*/
 #include <algorithm>
+#include <deque>
 #include <list>
 
+#include "checkpoint.h"
 #include "elimination.h"
+#include "incremental.h"
+#include "multiplier_simulation.h"
+#include "progress.h"
+#include "resource_limits.h"
+#include "spill.h"
+#include "trace.h"
 /*------------------------------------------------------------------------*/
 // Global variables
-int proof = 0;
+thread_local int proof = 0;
+thread_local unsigned max_counter_examples = 0;
+thread_local std::vector<std::vector<bool>> counter_examples;
 
 /*------------------------------------------------------------------------*/
 // ERROR CODES:
@@ -25,19 +35,19 @@ static int err_witness = 62; // cannot write to
 // Local variables
 
 // / used to collect the factors of each slice for PAC proofs
-static std::vector<Polynomial*> factors_per_slice;
+static thread_local std::vector<Polynomial*> factors_per_slice;
 
 // / used to collect the cofactors of each slice for PAC proofs
-static std::vector<const Polynomial*> co_factors;
+static thread_local std::vector<const Polynomial*> co_factors;
 
 // / used to collect the cofactors of each slice for PAC proofs
-static std::vector<int> factor_indices;
+static thread_local std::vector<int> factor_indices;
 
 // / used to collect the cofactors of each slice spec for PAC proofs
-static std::vector<int> spec_indices;
+static thread_local std::vector<int> spec_indices;
 
 // / used to collect the specification of each slice for PAC proofs
-static std::vector<Polynomial*> spec_of_slice;
+static thread_local std::vector<Polynomial*> spec_of_slice;
 
 /*-------------------------------------------------------------------------*/
 
@@ -171,7 +181,7 @@ void eliminate_by_one_gate(Gate * n1, Gate *n2, FILE * file) {
 }
 
 /*------------------------------------------------------------------------*/
-const Polynomial * cofac_tmp, * base_tmp, * mul_tmp;
+thread_local const Polynomial * cofac_tmp, * base_tmp, * mul_tmp;
 
 Polynomial * reduce_by_one_poly(
     const Polynomial * p1, Gate * n, FILE * file) {
@@ -223,6 +233,7 @@ Polynomial * reduce_by_one_poly(
 /*------------------------------------------------------------------------*/
 
 void remove_internal_xor_gates(FILE * file) {
+  TRACE_SCOPE("remove_internal_xor_gates");
   msg("remove internal xor gates");
   int counter = 0;
   for (unsigned i = NN; i < M-1; i++) {
@@ -296,6 +307,7 @@ void remove_internal_xor_gates(FILE * file) {
 /*------------------------------------------------------------------------*/
 
 void remove_single_occs_gates(FILE * file) {
+  TRACE_SCOPE("remove_single_occs_gates");
   msg("remove single occurence gates");
   int counter = 0;
   for (unsigned i = NN; i < M-1; i++) {
@@ -347,62 +359,78 @@ void remove_single_occs_gates(FILE * file) {
 }
 
 /*------------------------------------------------------------------------*/
-int remove_not_assigned_gate(FILE * file, Gate * n, int count){
-  if(n->get_input()) return count;
-  if(n->get_elim()) return count;
-//  if (n->get_slice() > -1) return count;
-
+// / work stack of remove_not_assigned_gate
+static thread_local std::vector<Gate*> remove_stack;
 
+/**
+    Eliminates the gate n and, depth-first, all its children that are not
+    used anymore
 
-  for (std::list<Gate*>::const_iterator it_c = n->children_begin();
-      it_c != n->children_end(); ++it_c) {
-    Gate * n_child = *it_c;
-    n_child->parents_remove(n);
-  }
+    @param file output file for PAC proofs
+    @param n Gate*
+    @param count integer number of removed gates so far
 
-  for (std::list<Gate*>::const_iterator it_p = n->parents_begin();
-      it_p != n->parents_end(); ++it_p) {
-    Gate * n_parent = *it_p;
-    if (n_parent->get_elim()) continue;
-    eliminate_by_one_gate(n_parent, n, file);
-    n_parent->children_remove(n);
+    @return count increased by the number of removed gates
+*/
+static int remove_not_assigned_gate(FILE * file, Gate * n, int count){
+  remove_stack.clear();
+  remove_stack.push_back(n);
+  while (!remove_stack.empty()) {
+    n = remove_stack.back();
+    remove_stack.pop_back();
+    if(n->get_input()) continue;
+    if(n->get_elim()) continue;
 
     for (std::list<Gate*>::const_iterator it_c = n->children_begin();
         it_c != n->children_end(); ++it_c) {
       Gate * n_child = *it_c;
-
-      if (!n_parent->is_child(n_child))
-        n_parent->children_push_back(n_child);
-      if (!n_child->is_in_parents(n_parent))
-        n_child->parents_push_back(n_parent);
+      n_child->parents_remove(n);
     }
-  }
 
-  if (proof == 1 || proof == 2) {
-    assert(file);
-    print_pac_del_rule(file, n->get_gate_constraint());
-  }
+    for (std::list<Gate*>::const_iterator it_p = n->parents_begin();
+        it_p != n->parents_end(); ++it_p) {
+      Gate * n_parent = *it_p;
+      if (n_parent->get_elim()) continue;
+      eliminate_by_one_gate(n_parent, n, file);
+      n_parent->children_remove(n);
 
-  n->mark_elim();
-  count++;
-  delete(n->get_gate_constraint());
-  n->set_gate_constraint(0);
+      for (std::list<Gate*>::const_iterator it_c = n->children_begin();
+          it_c != n->children_end(); ++it_c) {
+        Gate * n_child = *it_c;
+
+        if (!n_parent->is_child(n_child))
+          n_parent->children_push_back(n_child);
+        if (!n_child->is_in_parents(n_parent))
+          n_child->parents_push_back(n_parent);
+      }
+    }
+
+    if (proof == 1 || proof == 2) {
+      assert(file);
+      print_pac_del_rule(file, n->get_gate_constraint());
+    }
 
-  if (verbose >= 3) msg("removed %s", n->get_var_name());
+    n->mark_elim();
+    count++;
+    delete(n->get_gate_constraint());
+    n->set_gate_constraint(0);
 
-  for (std::list<Gate*>::const_iterator it_c = n->children_begin();
-      it_c != n->children_end(); ++it_c) {
-    Gate * n_child = *it_c;
-    count = remove_not_assigned_gate(file, n_child, count);
+    if (verbose >= 3) msg("removed %s", n->get_var_name());
 
+    // push in reverse order to visit the children from first to last
+    for (std::list<Gate*>::const_reverse_iterator it_c = n->children_rbegin();
+        it_c != n->children_rend(); ++it_c) {
+      remove_stack.push_back(*it_c);
+    }
   }
 
   return count;
-
 }
 
+/*------------------------------------------------------------------------*/
 
 void remove_slice_minus_one_gates(FILE * file) {
+  TRACE_SCOPE("remove_slice_minus_one_gates");
   msg("remove gates that are not assigned to slices");
   int counter = 0;
   for (unsigned i = NN; i < M-1; i++) {
@@ -418,58 +446,62 @@ void remove_slice_minus_one_gates(FILE * file) {
     msg("removed %i gates that are not assigned to slices", counter);
 }
 
+
 /*------------------------------------------------------------------------*/
 
 void decomposing(FILE * file) {
+  TRACE_SCOPE("decomposing");
   msg("eliminate single occs");
   int counter = 0;
   int begin = xor_chain ? NN-2 : NN-1;
+  assert(slices_are_consistent());
+
+  // Gates are visited in slice order first. Afterwards only those children
+  // are revisited whose parent count dropped to one by an elimination.
+  std::deque<Gate*> worklist;
   for (int i = begin; i >= 0; i--) {
-    bool change = 1;
-    while (change) {
-      change = 0;
-      for (std::list<Gate*>::const_iterator it =slices[i].begin();
-          it != slices[i].end(); ++it) {
-        Gate * n = *it;
-        if (n->get_elim()) continue;
-
-        if (n->parents_size() == 1 && !n->get_carry_gate()) {
-          Gate * parent = n->parents_front();
-
-          eliminate_by_one_gate(parent, n, file);
-          parent->children_remove(n);
-
-
-          for (std::list<Gate*>::const_iterator it=n->children_begin();
-              it != n->children_end(); ++it) {
-            Gate * n_child = *it;
-            if (!parent->is_child(n_child))
-              parent->children_push_back(n_child);
-
-            n_child->parents_remove(n);
-
-            if (!n_child->is_in_parents(parent))
-              n_child->parents_push_back(parent);
-          }
-          if (proof == 1 || proof == 2) {
-            assert(file);
-            print_pac_del_rule(file, n->get_gate_constraint());
-          }
-
-          n->mark_elim();
-          delete(n->get_gate_constraint());
-          n->set_gate_constraint(0);
-
-          counter++;
-
-          ++it;
-          slices[i].remove(n);
-          change = 1;
-
-          if (verbose >= 3)
-            msg("decomposed %s", n->get_var_name());
-        }
+    worklist.assign(slices[i].begin(), slices[i].end());
+
+    while (!worklist.empty()) {
+      Gate * n = worklist.front();
+      worklist.pop_front();
+      if (n->get_elim()) continue;
+      if (n->parents_size() != 1 || n->get_carry_gate()) continue;
+
+      Gate * parent = n->parents_front();
+
+      eliminate_by_one_gate(parent, n, file);
+      parent->children_remove(n);
+
+      for (std::list<Gate*>::const_iterator it=n->children_begin();
+          it != n->children_end(); ++it) {
+        Gate * n_child = *it;
+        if (!parent->is_child(n_child))
+          parent->children_push_back(n_child);
+
+        n_child->parents_remove(n);
+
+        if (!n_child->is_in_parents(parent))
+          n_child->parents_push_back(parent);
+
+        if (n_child->get_slice() == i && !n_child->get_elim() &&
+            n_child->parents_size() == 1)
+          worklist.push_back(n_child);
+      }
+      if (proof == 1 || proof == 2) {
+        assert(file);
+        print_pac_del_rule(file, n->get_gate_constraint());
       }
+
+      n->mark_elim();
+      delete(n->get_gate_constraint());
+      n->set_gate_constraint(0);
+      slices[i].remove(n);
+
+      counter++;
+
+      if (verbose >= 3)
+        msg("decomposed %s", n->get_var_name());
     }
   }
   msg("decomposed %i variables", counter);
@@ -478,6 +510,7 @@ void decomposing(FILE * file) {
 /*------------------------------------------------------------------------*/
 
 void eliminate_booth_pattern(FILE * file) {
+  TRACE_SCOPE("eliminate_booth_pattern");
   msg("eliminate booth pattern");
   int counter = 0;
   for (unsigned i = NN; i < M-1; i++) {
@@ -706,14 +739,31 @@ void correct_pp(const Polynomial * p, FILE * file) {
 /*------------------------------------------------------------------------*/
 
 const Polynomial * reduce(FILE * file) {
+  TRACE_SCOPE("reduce");
   msg("");
   msg("");
   msg("started reducing");
   Polynomial * rem = 0, * tmp;
-  for (int i=NN-1; i>= 0; i--) {
+  int first = NN-1;
+  if (resume_name) rem = resume_reduction(first);
+  else if (incremental_name || save_remainders_name)
+    rem = init_incremental(first);
+  init_checkpoints();
+  init_progress(first);
+  init_resource_limits();
+
+  for (int i=first; i>= 0; i--) {
+    TRACE_SLICE("slice", i);
+    checkpoint_reduction(i, rem);
     if (verbose >= 1) msg("reducing by slice %i", i);
     Polynomial * inc_spec = inc_spec_poly(i);
 
+    if (spill_remainder(rem)) {
+      rem = reduce_slice_out_of_core(i, 0, rem, inc_spec);
+      profile_slice(i, rem);
+      continue;
+    }
+
     if (rem) {
       tmp = add_poly(inc_spec, rem);
       delete(inc_spec);
@@ -723,8 +773,8 @@ const Polynomial * reduce(FILE * file) {
       rem = inc_spec;
     }
 
-    std::list<Gate*> sl = slices[i];
-    for (std::list<Gate*>::const_iterator it=sl.begin(); it != sl.end(); ++it) {
+    const Slice & sl = slices[i];
+    for (Slice::const_iterator it=sl.begin(); it != sl.end(); ++it) {
       Gate * n = *it;
       if (n->get_elim()) continue;
 
@@ -740,20 +790,29 @@ const Polynomial * reduce(FILE * file) {
 
       delete(rem);
       rem = tmp;
+      check_resource_limits(i, rem);
+      report_progress(i, rem);
 
       if (verbose >= 3) {
         fputs("[amulet2] remainder is ", stdout);
         rem->print(stdout);
         msg(" ");
       }
+
+      if (spill_remainder(rem)) {
+        rem = reduce_slice_out_of_core(i, n, rem, 0);
+        break;
+      }
     }
 
-    if (verbose >= 2) {
+    if (verbose >= 2 && rem) {
       msg("after reducing by slice %i", i);
       fprintf(stdout, "[amulet2] remainder is ");
       rem->print(stdout);
       msg("");
     }
+    profile_slice(i, rem);
+    save_slice_remainder(i, rem);
 
     if (proof == 1 || proof == 2) {
       Polynomial * pac_poly = add_up_factors(file, proof == 1);
@@ -773,10 +832,12 @@ const Polynomial * reduce(FILE * file) {
   }
 
   if (proof == 1)  {
+    TRACE_SCOPE("add_up_spec_of_slice");
     Polynomial * res = add_up_spec_of_slice(file, 1);
     if (xor_chain) correct_pp(res, file);
     delete(res);
   } else if (proof == 2) {
+    TRACE_SCOPE("add_up_spec_of_slice");
     Polynomial * res = add_up_spec_of_slice(file, 0);
     print_pac_vector_add_rule(file, spec_indices, res);
     spec_indices.clear();
@@ -786,6 +847,9 @@ const Polynomial * reduce(FILE * file) {
     delete(res);
   }
 
+  rem = finish_spilling(rem);
+  finish_checkpoints();
+  finish_incremental();
   return rem;
 }
 
@@ -806,57 +870,37 @@ bool check_inputs_only(const Polynomial *p) {
 
 /*------------------------------------------------------------------------*/
 
-void write_witness_vector(const Term * t, FILE * file) {
-  fputs_unlocked("[amulet2]   ", stdout);
-
-  if(ainc == 2){
-    for (unsigned i = 0; i <= NN/2-1; i++) {
-      const Var * v = gates[a0+i*ainc]->get_var();
-
-      if (t->contains(v)) {
-        fprintf(file, "1");
-        fprintf(stdout, "%s = ", v->get_name());
-      } else {
-        fprintf(file, "0");
-      }
-
-      const Var * w = gates[b0+i*binc]->get_var();
+void write_witness_vector(const std::vector<bool> & cex, FILE * file) {
+  assert(cex.size() == NN);
+  counter_examples.push_back(cex);
 
-      if (t->contains(w)) {
-        fprintf(file, "1");
-        fprintf(stdout, "%s = ", w->get_name());
-      } else {
-        fprintf(file, "0");
-      }
-    }
-
-  } else if (ainc == 1){
-    for (unsigned i = 0; i <= NN/2-1; i++) {
-      const Var * v = gates[a0+i*ainc]->get_var();
+  if (std::find(cex.begin(), cex.end(), 1) == cex.end()) {
+    msg("  all inputs = 0;\n");
+  } else if (!quiet) {
+    fputs_unlocked("[amulet2]   ", stdout);
+    for (unsigned i = 0; i < NN; i++)
+      if (cex[i]) fprintf(stdout, "%s = ", gates[i]->get_var_name());
+    fprintf(stdout, "1, all other inputs = 0;\n");
+  }
 
-      if (t->contains(v)) {
-        fprintf(file, "1");
-        fprintf(stdout, "%s = ", v->get_name());
-      } else {
-        fprintf(file, "0");
-      }
-    }
+  if (!file) return;
+  for (unsigned i = 0; i < NN; i++) fputc_unlocked(cex[i] ? '1' : '0', file);
+  fputc_unlocked('\n', file);
+}
 
-    for (unsigned i = 0; i <= NN/2-1; i++) {
-      const Var * w = gates[b0+i*binc]->get_var();
+/*------------------------------------------------------------------------*/
 
-      if (t->contains(w)) {
-        fprintf(file, "1");
-        fprintf(stdout, "%s = ", w->get_name());
-      } else {
-        fprintf(file, "0");
-      }
-    }
-  }
+/**
+    Returns the input vector, where exactly the inputs of t are set to 1
 
+    @param t const Term*, may be 0 for the constant term
 
-  fprintf(stdout, "1, all other inputs = 0;\n");
-  fprintf(file, "\n");
+    @return std::vector<bool> ordered as the inputs of the AIG
+*/
+static std::vector<bool> term_to_input_vector(const Term * t) {
+  std::vector<bool> res(NN, 0);
+  for (; t; t = t->get_rest()) res[t->get_var_num()/2 - 1] = 1;
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
@@ -864,49 +908,56 @@ void write_witness_vector(const Term * t, FILE * file) {
 void write_witnesses(const Polynomial * p, FILE * file) {
   assert(check_inputs_only(p));
 
-  int len = p->min_term_size();
-  if (len == 0) {
-    msg("  all inputs = 0;\n");
-    for (unsigned i = 0; i <= NN/2-1; i++)
-      fprintf(file, "00");
-
-    fprintf(file, "\n");
-  } else {
-    for (size_t i = 0 ; i < p->size(); i++) {
-      Monomial * m = p->get_mon(i);
-      if (m->get_term()) {
-        int tlen = m->get_term_size();
-        if (tlen == len) write_witness_vector(m->get_term(), file);
-      }
-    }
+  // candidates are the terms of the remainder, smallest terms first,
+  // by default only the terms of minimal size are used
+  std::vector<const Term*> terms;
+  unsigned len = p->min_term_size();
+  for (size_t i = 0 ; i < p->size(); i++) {
+    const Term * t = p->get_mon(i)->get_term();
+    unsigned tlen = t ? t->size() : 0;
+    if (tlen == len || max_counter_examples) terms.push_back(t);
   }
-  fprintf(file, ".");
-}
-
-/*------------------------------------------------------------------------*/
+  std::stable_sort(terms.begin(), terms.end(),
+    [](const Term * s, const Term * t) {
+      return (s ? s->size() : 0) < (t ? t->size() : 0);
+    });
+
+  std::vector<std::vector<bool>> cands;
+  for (size_t i = 0; i < terms.size(); i++)
+    cands.push_back(term_to_input_vector(terms[i]));
+
+  std::vector<bool> valid = validate_counter_examples(cands);
+  std::vector<std::vector<bool>> cexs;
+  for (size_t i = 0; i < cands.size(); i++) {
+    if (max_counter_examples && cexs.size() == max_counter_examples) break;
+    if (valid[i]) cexs.push_back(cands[i]);
+  }
+  size_t invalid = std::count(valid.begin(), valid.end(), 0);
+  if (invalid)
+    msg("%zu candidate(s) from the remainder are not counter examples",
+      invalid);
 
-void generate_witness(const Polynomial * p, const char * name) {
-  if (!check_inputs_only(p))
-  die(err_witness, "cannot generate witness, as remainder polynomial contains non-inputs");
+  if (cexs.size() < max_counter_examples)
+    find_counter_examples(max_counter_examples, cexs);
 
-  #define WITNESSLEN 100
-  char witness_name[WITNESSLEN];
-  memset(witness_name, '\0', sizeof(witness_name));
-  for (int i = 0; name[i] != '.'; i++) {
-    witness_name[i] = name[i];
-  }
-  snprintf(witness_name + strlen(witness_name),
-           WITNESSLEN - strlen(witness_name), "%s", ".cex");
+  for (size_t i = 0; i < cexs.size(); i++) write_witness_vector(cexs[i], file);
+  if (file) fprintf(file, ".");
+}
 
-  FILE * witness_file;
-  if (!(witness_file = fopen(witness_name, "w")))
-  die(err_writing, "cannot write output to '%s'", witness_name);
+/*------------------------------------------------------------------------*/
 
-  msg("");
-  msg("COUNTER EXAMPLES ARE: ");
+std::string witness_file_name(const char * name) {
+  std::string res = name;
+  size_t dir = res.find_last_of('/');
+  size_t dot = res.find('.', dir == std::string::npos ? 0 : dir + 1);
+  if (dot != std::string::npos) res.erase(dot);
+  return res + ".cex";
+}
 
-  write_witnesses(p, witness_file);
+/*------------------------------------------------------------------------*/
 
+void print_witness_note(const char * name, const char * witness_name) {
+  if (quiet) return;
   msg("");
   msg("");
   msg("Counter examples are written to %s", witness_name);
@@ -930,6 +981,30 @@ void generate_witness(const Polynomial * p, const char * name) {
     fprintf(stdout, "  a[0]a[1]...a[%u]b[0]b[1]...b[%u]  s[0]s[1]s[2]...s[%u]\n",
       NN/2-1, NN/2-1, NN-1);
   }
+}
+
+/*------------------------------------------------------------------------*/
+
+void generate_witness(const Polynomial * p, const char * name) {
+  TRACE_SCOPE("generate_witness");
+  if (!check_inputs_only(p))
+  die(err_witness, "cannot generate witness, as remainder polynomial contains non-inputs");
+
+  std::string witness_name;
+  FILE * witness_file = 0;
+  if (name) {
+    witness_name = witness_file_name(name);
+    if (!(witness_file = fopen(witness_name.c_str(), "w")))
+    die(err_writing, "cannot write output to '%s'", witness_name.c_str());
+  }
+
+  msg("");
+  msg("COUNTER EXAMPLES ARE: ");
+
+  write_witnesses(p, witness_file);
+  if (!witness_file) return;
+
+  print_witness_note(name, witness_name.c_str());
 
   fclose(witness_file);
 }
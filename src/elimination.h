@@ -13,17 +13,27 @@
 #define AMULET2_SRC_ELIMINATION_H_
 /*------------------------------------------------------------------------*/
 #include <string.h>
+#include <string>
 
 #include <vector>
 
 #include "nss.h"
 #include "pac.h"
+#include "profiler.h"
 #include "slicing.h"
 /*------------------------------------------------------------------------*/
 // / 1 for pac
 // / 2 for hybrid
 // / 3 for nss
-extern int proof;
+extern thread_local int proof;
+
+// / Number of counter examples written for incorrect multipliers, if 0 one
+// / counter example is written for each smallest term of the remainder
+extern thread_local unsigned max_counter_examples;
+
+// / Counter examples passed to write_witness_vector, ordered as the inputs
+// / of the AIG, collected for the library interface
+extern thread_local std::vector<std::vector<bool>> counter_examples;
 
 /*------------------------------------------------------------------------*/
 // Functions used for PAC proofs
@@ -184,29 +194,53 @@ const Polynomial * reduce(FILE * file);
 bool check_inputs_only(const Polynomial *p);
 
 /**
-    Writes a vector to the file such that all input variables in the term t
-    are set to 1, all other to 0.
+    Prints the inputs that are set in the counter example and writes the
+    vector to the file
 
-    @param t Term
-    @param file output file for the counter example
+    @param cex const std::vector<bool> & values of the inputs in the order
+               of the AIG inputs, appended to counter_examples
+    @param file output file for the counter example, may be 0
 */
-void write_witness_vector(const Term * t, FILE * file);
+void write_witness_vector(const std::vector<bool> & cex, FILE * file);
 
 /**
-    Search for the smallest term and calls write_witness_vector on that
+    Uses the smallest terms of p (all terms if max_counter_examples is set)
+    as candidates, keeps those that are validated by simulation and calls
+    write_witness_vector on them. Further counter examples are searched by
+    simulation if max_counter_examples is not reached.
 
     @param p Polynomial* for which counter examples are generated
-    @param file output file for the counter example
+    @param file output file for the counter example, may be 0
 */
 void write_witnesses(const Polynomial * p, FILE * file);
 
+/**
+    Returns the name of the counter example file for the input file name,
+    where everything after the first '.' of the base name is replaced by
+    '.cex'
+
+    @param name char * name of the input file
+
+    @return std::string
+*/
+std::string witness_file_name(const char * name);
+
+/**
+    Prints how the counter examples in witness_name can be simulated
+
+    @param name char * name of the input file
+    @param witness_name char * name of the counter example file
+*/
+void print_witness_note(const char * name, const char * witness_name);
+
 /**
     Generates a witness for the remainder polynomial p, by identifying
     the smallest term in the polynomial and setting all its variables
     to 1.
 
     @param p Polynomial* for which counter examples are generated
-    @param name prefix name for the output file, suffix is '.cex'
+    @param name prefix name for the output file, suffix is '.cex',
+                if 0 the counter examples are only collected
 */
 void generate_witness(const Polynomial * p, const char * name);
 
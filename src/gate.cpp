@@ -7,15 +7,21 @@
   Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
 */
 /*------------------------------------------------------------------------*/
+#include <exception>
 #include <string>
 #include <list>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "gate.h"
+#include "trace.h"
 /*------------------------------------------------------------------------*/
 // Global variables
-bool xor_chain = 0;
-bool booth = 0;
-bool signed_mult = 0;
+thread_local bool xor_chain = 0;
+thread_local bool booth = 0;
+thread_local bool signed_mult = 0;
+thread_local unsigned num_threads = 1;
 /*------------------------------------------------------------------------*/
 // ERROR CODES:
 static int err_allocate       = 91; // failed to allocate gates
@@ -74,7 +80,7 @@ bool Gate::is_child(const Gate * n) const {
 
 /*------------------------------------------------------------------------*/
 Polynomial * Gate::get_gate_constraint() const {
-  if (!gate_constraint && !elim) {
+  if (!constraint_set && !elim) {
     // output aig are 0, -1, ...-NN+2
     if (output) init_gate_constraint(-1*get_var_num()+M-1);
     // gates are numbered 2,4,6,8,..
@@ -84,10 +90,26 @@ Polynomial * Gate::get_gate_constraint() const {
   return gate_constraint;
 }
 
-Gate ** gates;
-unsigned num_gates;
+thread_local Gate ** gates;
+thread_local unsigned num_gates;
 // dedicated constant-0 gate
-Gate * const0_gate = 0;
+thread_local Gate * const0_gate = 0;
+// epoch of the current traversal
+static thread_local unsigned visit_epoch = 0;
+
+/*------------------------------------------------------------------------*/
+
+unsigned new_visit_epoch() {
+  if (++visit_epoch == 0) {
+    // wrapped around, reset all marks once
+    for (unsigned i = 0; i < num_gates; i++) gates[i]->visit(0);
+    if (const0_gate) const0_gate->visit(0);
+    visit_epoch = 1;
+  }
+  return visit_epoch;
+}
+
+void swap_visit_epoch(unsigned & epoch) { std::swap(visit_epoch, epoch); }
 
 /*------------------------------------------------------------------------*/
 
@@ -186,6 +208,7 @@ Gate * derive_ha_and_gate(const Gate *n) {
 /*------------------------------------------------------------------------*/
 
 void set_xor() {
+  TRACE_SCOPE("set_xor");
   int found_xor = 0;
   for (unsigned i = 0; i < M; i++) {
     Gate * n = gates[i];
@@ -406,94 +429,158 @@ Polynomial * positive_poly(const Var * v) {
 }
 
 /*------------------------------------------------------------------------*/
-static Polynomial * get_node_constraint(Gate * g, unsigned sign){
-  // If g is the dedicated constant-0 gate, treat like missing gate
+// Gate constraints are of the form -v + L*R for an AND gate, where L and R
+// are the literals 'l' or '1-l' of the inputs, and -v + L for an output.
+// Thus they contain at most five monomials and are generated directly
+// instead of using the general polynomial arithmetic.
+
+// / maximal number of monomials in a gate constraint
+static const unsigned max_constraint_size = 5;
+
+/**
+    Determines the literal of gate g as 'c + d*t'
+
+    @param g Gate*, constant 0 if g is 0 or the constant-0 gate
+    @param sign unsigned, true if the literal is negated
+    @param c integer, constant part
+    @param d integer, coefficient of the term
+    @param t Term* of the gate, 0 if g is constant
+*/
+static void literal_constraint(
+    const Gate * g, unsigned sign, int * c, int * d, Term ** t) {
+  *c = sign ? 1 : 0;
   if (g && g != const0_gate) {
-    const Var * v1 = g->get_var();
-    if (sign) return negative_poly(v1);
-    else return positive_poly(v1);
+    *d = sign ? -1 : 1;
+    *t = new_term(g->get_var(), 0);
   } else {
-    // g is NULL or constant-0: return constant 1 for negated literal, 0 otherwise
-    if(sign) {
-      push_mstack_end(new Monomial(one, 0));
-      return build_poly();
-    } else return 0;
+    *d = 0;
+    *t = 0;
   }
 }
 
+/**
+    Compares two terms of a gate constraint, where 0 is the constant term
+
+    @param t1 Term*
+    @param t2 Term*
+
+    @return +1 if t1 > t2, -1 if t1 < t2, 0 if t1 = t2
+*/
+static int cmp_constraint_terms(const Term * t1, const Term * t2) {
+  if (t1 == t2) return 0;
+  if (!t1) return -1;
+  if (!t2) return 1;
+  return t1->cmp(t2);
+}
+
+/**
+    Builds the polynomial sum(coeffs[i]*terms[i]) by sorting the at most
+    max_constraint_size monomials and merging equal terms. The monomial
+    array is handed over to the polynomial without using the mstack.
+
+    @param coeffs integer array of coefficients
+    @param terms Term* array, takes over the references of the terms
+    @param len unsigned number of monomials
+
+    @return Polynomial*
+*/
+static Polynomial * build_constraint(int * coeffs, Term ** terms, unsigned len) {
+  assert(len <= max_constraint_size);
+  for (unsigned i = 1; i < len; i++) {
+    for (unsigned j = i;
+        j > 0 && cmp_constraint_terms(terms[j-1], terms[j]) < 0; j--) {
+      std::swap(terms[j-1], terms[j]);
+      std::swap(coeffs[j-1], coeffs[j]);
+    }
+  }
+
+  Monomial ** mon = new Monomial*[len];
+  size_t num = 0;
+  mpz_t coeff;
+  mpz_init(coeff);
+  for (unsigned i = 0; i < len; i++) {
+    Term * t = terms[i];
+    int c = coeffs[i];
+    while (i+1 < len && terms[i+1] == t) {
+      c += coeffs[++i];
+      deallocate_term(terms[i]);
+    }
+    if (!c) {
+      deallocate_term(t);
+      continue;
+    }
+    mpz_set_si(coeff, c);
+    mon[num++] = new Monomial(coeff, t);
+  }
+  mpz_clear(coeff);
+  return new Polynomial(mon, num);
+}
+
 /*------------------------------------------------------------------------*/
 
 Polynomial * gen_gate_constraint(unsigned i) {
   assert(i >= NN && i < M + NN - 1);
-  Polynomial * p = 0;
+  Gate * n = gates[i];
+  int coeffs[max_constraint_size];
+  Term * terms[max_constraint_size];
+  unsigned len = 0;
+
+  coeffs[len] = -1;
+  terms[len++] = new_term(n->get_var(), 0);
+
+  int cl, dl, cr, dr;
+  Term * lt, * rt;
   // gate constraint
   if (i < M-1) {
-    Gate * n = gates[i];
     assert(!n->get_input());
 
     aiger_and * and1 = is_model_and(n->get_var_num());
     assert(and1);
 
-    unsigned l = and1->rhs0, r = and1->rhs1;
+    literal_constraint(gate(and1->rhs0), aiger_sign(and1->rhs0), &cl, &dl, &lt);
+    literal_constraint(gate(and1->rhs1), aiger_sign(and1->rhs1), &cr, &dr, &rt);
 
-    Gate * l_gate = gate(l), *r_gate = gate(r);
-    const Var * v = n->get_var();
-    Term * t1 = new_term(v, 0);
-    Monomial * m1 = new Monomial(minus_one, t1);
-    push_mstack_end(m1);
-    Polynomial * p_h = build_poly();
-
-    Polynomial * p1 = get_node_constraint(l_gate, aiger_sign(and1->rhs0));
-    Polynomial * p2 = get_node_constraint(r_gate, aiger_sign(and1->rhs1));
-    Polynomial * p_tl = multiply_poly(p1, p2);
-
-    p = add_poly(p_h, p_tl);
-    delete(p_h);
-    delete(p_tl);
-
-    delete(p1);
-    delete(p2);
+    // (cl + dl*l)*(cr + dr*r) = dl*dr*l*r + dl*cr*l + cl*dr*r + cl*cr
+    if (dl && dr) {
+      coeffs[len] = dl*dr;
+      terms[len++] = multiply_term(lt, rt);
+    }
+    if (dl && cr) {
+      coeffs[len] = dl*cr;
+      terms[len++] = lt->copy();
+    }
+    if (cl && dr) {
+      coeffs[len] = cl*dr;
+      terms[len++] = rt->copy();
+    }
+    if (cl && cr) {
+      coeffs[len] = cl*cr;
+      terms[len++] = 0;
+    }
+    deallocate_term(lt);
+    deallocate_term(rt);
   } else {  // output
-    Gate * n = gates[i];
     assert(n->get_output());
 
-    Gate * model_output_gate = n->children_front();
-    if (!model_output_gate) {
-      unsigned lit = slit(i-M+1);
-      const Var * v = n->get_var();
-      Term * t1 = new_term(v, 0);
-      Monomial * m1 = new Monomial(minus_one, t1);
-      push_mstack_end(m1);
-      if(lit == 1){
-        push_mstack_end(new Monomial(one, 0));
-      }
-      p = build_poly();
-
-    } else {
-      const Var * v = n->get_var();
-      Term * t1 = new_term(v, 0);
-      Monomial * m1 = new Monomial(minus_one, t1);
-
-      Polynomial * p_tl;
-      if (aiger_sign(slit(i-M+1)))
-        p_tl = negative_poly(model_output_gate->get_var());
-      else
-        p_tl = positive_poly(model_output_gate->get_var());
+    Gate * model_output_gate = n->children_size() ? n->children_front() : 0;
+    literal_constraint(
+      model_output_gate, aiger_sign(slit(i-M+1)), &cl, &dl, &lt);
 
-      push_mstack_end(m1);
-      Polynomial * p_h = build_poly();
-
-      p = add_poly(p_h, p_tl);
-      delete(p_h);
-      delete(p_tl);
+    if (dl) {
+      coeffs[len] = dl;
+      terms[len++] = lt;
+    }
+    if (cl) {
+      coeffs[len] = cl;
+      terms[len++] = 0;
     }
-
   }
+
+  Polynomial * p = build_constraint(coeffs, terms, len);
   p->set_idx(2+i-NN);
   return p;
 }
 
-
 void init_gate_constraint(unsigned i) {
   assert(i >= NN && i < M + NN - 1);
   Polynomial * p = gen_gate_constraint(i);
@@ -502,14 +589,117 @@ void init_gate_constraint(unsigned i) {
 }
 
 
+/*------------------------------------------------------------------------*/
+// Gate constraints are independent of each other. Every worker generates the
+// gate constraints of a range of gates on its own mstack and term table.
+// Afterwards the terms are moved to the term table of the main thread, which
+// is the only one used in the remaining computation.
+
+// / State of the main thread that is read by the workers, because the
+// / gates and the AIG are thread local
+struct Worker_state {
+  unsigned M, NN;       // /< sizes of the AIG
+  Gate ** gates;        // /< gates of the main thread
+  unsigned num_gates;   // /< number of gates
+  Gate * const0_gate;   // /< constant-0 gate of the main thread
+  aiger * model;        // /< AIG of the main thread
+  int verbose;          // /< verbosity of the main thread
+  bool quiet;           // /< quiet flag of the main thread
+  bool throw_errors;    // /< die throws in the main thread
+};
+
+/**
+    Generates the gate constraints of gates[begin] until gates[end-1]
+
+    @param begin unsigned
+    @param end unsigned
+    @param state const Worker_state* of the main thread
+    @param terms std::vector<Term*> receiving the terms of the worker
+    @param error std::exception_ptr receiving an exception of the worker,
+                 which is rethrown by the main thread after joining
+*/
+static void gen_gate_constraints_range(unsigned begin, unsigned end,
+    const Worker_state * state, std::vector<Term*> * terms,
+    std::exception_ptr * error) {
+  M = state->M;
+  NN = state->NN;
+  gates = state->gates;
+  num_gates = state->num_gates;
+  const0_gate = state->const0_gate;
+  set_model(state->model);
+  verbose = state->verbose;
+  quiet = state->quiet;
+  throw_errors = state->throw_errors;
+
+  try {
+    for (unsigned i = begin; i < end; i++) init_gate_constraint(i);
+  } catch (...) {
+    // an exception must not leave the thread, the main thread rethrows it
+    *error = std::current_exception();
+  }
+  *terms = detach_terms();
+  deallocate_mstack();
+}
+
+/*------------------------------------------------------------------------*/
+
 void init_gate_constraints() {
-  for (unsigned i = NN; i < M-1; i++) {
-    init_gate_constraint(i);
+  TRACE_SCOPE("init_gate_constraints");
+  unsigned total = num_gates - NN;
+  unsigned threads = num_threads < total ? num_threads : total;
+
+  if (threads <= 1) {
+    for (unsigned i = NN; i < M-1; i++) {
+      init_gate_constraint(i);
+    }
+
+    for (unsigned i = 0; i < NN; i++) {
+      init_gate_constraint(i+M-1);
+    }
+    return;
   }
 
-  for (unsigned i = 0; i < NN; i++) {
-    init_gate_constraint(i+M-1);
+  Worker_state state = {
+    M, NN, gates, num_gates, const0_gate, get_model(), verbose, quiet,
+    throw_errors };
+  std::vector<std::vector<Term*>> terms(threads);
+  std::vector<std::exception_ptr> errors(threads);
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; t++) {
+    unsigned begin = NN + t*total/threads;
+    unsigned end = NN + (t+1)*total/threads;
+    workers.push_back(std::thread(
+      gen_gate_constraints_range, begin, end, &state, &terms[t],
+      &errors[t]));
   }
+  for (unsigned t = 0; t < threads; t++) workers[t].join();
+
+  // the constraints now belong to the main thread, after an error only
+  // those generated so far
+  for (unsigned i = NN; i < num_gates; i++) {
+    if (!gates[i]->has_gate_constraint()) continue;
+    Polynomial * p = gates[i]->get_gate_constraint();
+    num_polynomials++;
+    num_monomials += p->size();
+    for (size_t j = 0; j < p->size(); j++) {
+      Monomial * m = p->get_mon(j);
+      assert(m->get_ref() == 1);
+      m->set_term(import_term(m->get_term()));
+    }
+  }
+
+  for (unsigned t = 0; t < threads; t++) {
+    for (std::vector<Term*>::const_iterator it = terms[t].begin();
+        it != terms[t].end(); ++it) {
+      delete(*it);
+    }
+  }
+
+  for (unsigned t = 0; t < threads; t++)
+    if (errors[t]) std::rethrow_exception(errors[t]);
+
+  if (verbose >= 1)
+    msg("generated %u gate constraints using %u threads", total, threads);
 }
 
 /*------------------------------------------------------------------------*/
@@ -520,4 +710,6 @@ void delete_gates() {
     delete(gates[i]);
   }
   delete[] gates;
+  gates = 0;
+  num_gates = 0;
 }
@@ -19,19 +19,25 @@
 #include "polynomial.h"
 /*------------------------------------------------------------------------*/
 // / set to true when the last slice contains an xor_chain
-extern bool xor_chain;
+extern thread_local bool xor_chain;
 
 // / set to true when the multiplier contains a booth pattern
-extern bool booth;
+extern thread_local bool booth;
 
 // / set to true when a signed or unsigned multiplier is verified
-extern bool signed_mult;
+extern thread_local bool signed_mult;
+
+// / number of threads used to generate the gate constraints
+extern thread_local unsigned num_threads;
 /*------------------------------------------------------------------------*/
 
 /** \class Gate
   Internal structure to represent the AIG graph.
 */
 class Gate {
+  // / Slice maintains the position handles pos_slice, pos and pos_label
+  friend class Slice;
+
   // / Variable of the gate, as used in the polynomials
   const Var * v;
 
@@ -62,6 +68,15 @@ class Gate {
   // / slice a gate is attached to
   int slice = -1;
 
+  // / slice whose list contains the gate, -1 if none (see Slice)
+  int pos_slice = -1;
+
+  // / position of the gate in the list of slice pos_slice
+  std::list<Gate*>::iterator pos;
+
+  // / order-maintenance label of pos, increasing along the slice
+  uint64_t pos_label = 0;
+
   // / True if circuit is a prop_gen_gate(-substitute)
   bool prop_gen_gate = 0;
 
@@ -74,6 +89,9 @@ class Gate {
   // / True if gate occurs negative(-substitute)
   bool neg = 0;
 
+  // / Epoch of the last traversal that visited the gate
+  unsigned visited = 0;
+
   // / True if gate has been moved during fix_xors
   bool moved = 0;
 
@@ -83,9 +101,13 @@ class Gate {
   // / True if gate is eliminated during preprocessing
   bool elim = 0;
 
-  // / Polynomial implied by the aig gate
+  // / Polynomial implied by the aig gate, generated on first access
   Polynomial * gate_constraint = 0;
 
+  // / True if gate_constraint has been generated or set, it is then never
+  // / regenerated, even if it has been deleted in the meantime
+  bool constraint_set = 0;
+
   // / Polynomial generated as co-factor for nss proofs(-certify)
   Polynomial * co_factor = 0;
 
@@ -274,6 +296,19 @@ class Gate {
   */
   void unmark_prop_gen_gate() {prop_gen_gate = 0;}
 
+  /**
+      Marks the gate as visited in the traversal with the given epoch
+
+      @param epoch unsigned, see new_visit_epoch()
+
+      @return False if the gate has already been visited in this traversal
+  */
+  bool visit(unsigned epoch) {
+    if (visited == epoch) return 0;
+    visited = epoch;
+    return 1;
+  }
+
   /**
       Getter for fsa
 
@@ -354,18 +389,29 @@ class Gate {
   void mark_elim() {elim = 1;}
 
   /**
-      Getter for gate_constraint
+      Getter for gate_constraint, which generates the gate constraint
+      from the aig on first access
 
       @return member gate_constraint
   */
   Polynomial * get_gate_constraint() const;
 
+  /**
+      Returns whether the gate constraint has already been generated
+
+      @return member constraint_set
+  */
+  bool has_gate_constraint() const { return constraint_set; }
+
   /**
       Setter for gate_constraint
 
       @param p Polynomial *
   */
-  void set_gate_constraint(Polynomial * p) {gate_constraint = p;}
+  void set_gate_constraint(Polynomial * p) {
+    gate_constraint = p;
+    constraint_set = 1;
+  }
 
   /**
       Prints the gate constraint
@@ -503,6 +549,24 @@ class Gate {
     return children.end();
   }
 
+  /**
+      Getter for reverse begin of children
+
+      @return std::list<Gate*>::const_reverse_iterator
+  */
+  std::list<Gate*>::const_reverse_iterator children_rbegin() const {
+    return children.rbegin();
+  }
+
+  /**
+      Getter for reverse end of children
+
+      @return std::list<Gate*>::const_reverse_iterator
+  */
+  std::list<Gate*>::const_reverse_iterator children_rend() const {
+    return children.rend();
+  }
+
   /**
       Getter for size of children
 
@@ -588,10 +652,13 @@ class Gate {
 
 /*------------------------------------------------------------------------*/
 // / Gate ** where all gates are stored
-extern Gate ** gates;
+extern thread_local Gate ** gates;
 
 // / Counts the number of gates
-extern unsigned num_gates;
+extern thread_local unsigned num_gates;
+
+// / Gate representing the constant 0, not contained in gates
+extern thread_local Gate * const0_gate;
 /*------------------------------------------------------------------------*/
 
 /**
@@ -603,6 +670,23 @@ extern unsigned num_gates;
 */
 Gate * gate(unsigned lit);
 
+/**
+    Starts a new traversal, gates visited in earlier traversals count as
+    unvisited without clearing any marks
+
+    @returns unsigned epoch of the new traversal
+*/
+unsigned new_visit_epoch();
+
+/**
+    Exchanges the traversal epoch of the calling thread with the given one,
+    such that the marks of the gates of a verification context stay valid
+    when the context moves between threads
+
+    @param epoch unsigned &
+*/
+void swap_visit_epoch(unsigned & epoch);
+
 /**
     Allocate the Gate** gates and filling it
 */
@@ -708,7 +792,9 @@ void init_gate_constraint(unsigned i);
 
 
 /**
-    Initializes all gate constraints in the gates[]
+    Initializes all gate constraints in the gates[] upfront, using
+    num_threads worker threads. Otherwise the gate constraints are
+    generated lazily in Gate::get_gate_constraint
 */
 void init_gate_constraints();
 
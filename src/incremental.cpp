@@ -0,0 +1,451 @@
+/*------------------------------------------------------------------------*/
+/*! \file incremental.cpp
+    \brief incremental re-verification of a changed AIG from the saved
+    remainders of a previous run
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "incremental.h"
+#include "polynomial_solver.h"
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_saving      = 171;  // cannot write saved remainders
+static int err_incremental = 172;  // cannot read saved remainders
+/*------------------------------------------------------------------------*/
+// Global variables
+thread_local const char * save_remainders_name = 0;
+thread_local const char * incremental_name = 0;
+/*------------------------------------------------------------------------*/
+// Local variables
+
+// / identifier of the constant-0 gate, all other gates are identified by
+// / their index in gates
+static const uint64_t const0_id = 0xfffffffe;
+
+// / flag of identifiers of gates without a match in the saved design
+static const uint64_t unmatched = 1ull << 32;
+
+// / signatures of the slices of the current design
+static thread_local std::vector<uint64_t> signatures;
+
+// / remainders after each slice of the current design, as saved
+static thread_local std::vector<std::string> remainders;
+
+// / true if the remainder after the slice is known
+static thread_local std::vector<bool> have_remainder;
+/*------------------------------------------------------------------------*/
+
+/** \struct Saved_design
+    Contents of a file with saved remainders
+*/
+struct Saved_design {
+  unsigned M = 0, NN = 0, a0 = 0, ainc = 0, b0 = 0, binc = 0;
+  bool signed_mult = 0, xor_chain = 0;
+
+  // / operands of the AND gates, indexed by gate index - NN
+  std::vector<std::pair<unsigned, unsigned>> ands;
+
+  // / output literals
+  std::vector<unsigned> outputs;
+
+  // / signatures of the slices
+  std::vector<uint64_t> signatures;
+
+  // / remainders after each slice
+  std::vector<std::string> remainders;
+
+  // / true if the remainder after the slice is known
+  std::vector<bool> have_remainder;
+};
+
+/*------------------------------------------------------------------------*/
+
+static uint64_t mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+
+/*------------------------------------------------------------------------*/
+
+static uint64_t gate_id(const Var * v) {
+  if (v == const0_gate->get_var()) return const0_id;
+  int num = v->get_num();
+  return num > 0 ? num/2 - 1 : M - 1 - num;
+}
+
+/*------------------------------------------------------------------------*/
+// Identifier of v, renamed to the matched saved gate if rename is given
+static uint64_t renamed_id(const Var * v,
+                           const std::vector<uint64_t> * rename) {
+  uint64_t id = gate_id(v);
+  if (rename && id != const0_id) id = (*rename)[id];
+  return id;
+}
+
+/*------------------------------------------------------------------------*/
+// Hash of a polynomial, independent of the order of monomials and
+// variables, which depends on the numbering of the gates
+static uint64_t polynomial_signature(
+  const Polynomial * p, const std::vector<uint64_t> * rename) {
+  uint64_t res = 0;
+  for (size_t i = 0; i < p->size(); i++) {
+    const Monomial * m = p->get_mon(i);
+    uint64_t h = mix(mpz_sgn(m->coeff) + 2);
+    for (size_t j = 0; j < mpz_size(m->coeff); j++)
+      h = mix(h ^ mpz_getlimbn(m->coeff, j));
+    uint64_t vars = 0;
+    for (const Term * t = m->get_term(); t; t = t->get_rest())
+      vars += mix(renamed_id(t->get_var(), rename) + 0x9e3779b97f4a7c15ull);
+    res += mix(h ^ vars);
+  }
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+// Hash of the gate constraints of slice i. The gates of a slice are
+// reduced in topological order, and any such order yields the same
+// remainder, thus the hash does not depend on the order of the gates
+static uint64_t slice_signature(
+  unsigned i, const std::vector<uint64_t> * rename) {
+  uint64_t res = mix(i + 1);
+  const Slice & sl = slices[i];
+  for (Slice::const_iterator it = sl.begin(); it != sl.end(); ++it) {
+    Gate * n = *it;
+    if (n->get_elim()) continue;
+    uint64_t h = mix(renamed_id(n->get_var(), rename));
+    res += mix(h ^ polynomial_signature(n->get_gate_constraint(), rename));
+  }
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+// Writes the monomials of p, one per line, as coefficient and gate ids
+static std::string encode_polynomial(const Polynomial * p) {
+  std::string res;
+  std::vector<char> buf;
+  for (size_t i = 0; i < p->size(); i++) {
+    const Monomial * m = p->get_mon(i);
+    buf.resize(mpz_sizeinbase(m->coeff, 10) + 2);
+    res += mpz_get_str(buf.data(), 10, m->coeff);
+    for (const Term * t = m->get_term(); t; t = t->get_rest())
+      res += " " + std::to_string(gate_id(t->get_var()));
+    res += '\n';
+  }
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+// Renames the gate ids of an encoded polynomial, fails if a gate has no
+// new name
+static bool rename_polynomial(const std::string & text,
+  const std::vector<int64_t> & rename, std::string & res) {
+  std::istringstream in(text);
+  std::string line, coeff;
+  res.clear();
+  while (std::getline(in, line)) {
+    std::istringstream words(line);
+    words >> coeff;
+    res += coeff;
+    uint64_t id;
+    while (words >> id) {
+      if (id != const0_id) {
+        if (id >= rename.size() || rename[id] < 0) return 0;
+        id = rename[id];
+      }
+      res += " " + std::to_string(id);
+    }
+    res += '\n';
+  }
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+// Builds the polynomial of an encoded polynomial in the current ids
+static Polynomial * decode_polynomial(const std::string & text) {
+  std::istringstream in(text);
+  std::string line, coeff;
+  std::vector<Monomial*> mons;
+  std::vector<const Var*> vars;
+  mpz_t c;
+  mpz_init(c);
+  while (std::getline(in, line)) {
+    std::istringstream words(line);
+    words >> coeff;
+    mpz_set_str(c, coeff.c_str(), 10);
+    vars.clear();
+    uint64_t id;
+    while (words >> id)
+      vars.push_back(id == const0_id ?
+        const0_gate->get_var() : gates[id]->get_var());
+    std::sort(vars.begin(), vars.end(), [](const Var * a, const Var * b) {
+      return a->get_level() > b->get_level();
+    });
+    for (const Var * v : vars) add_to_vstack(v);
+    mons.push_back(new Monomial(c, build_term_from_stack()));
+  }
+  mpz_clear(c);
+
+  std::sort(mons.begin(), mons.end(), [](Monomial * a, Monomial * b) {
+    if (!a->get_term()) return false;
+    return a->get_term()->cmp(b->get_term()) > 0;
+  });
+  for (Monomial * m : mons) push_mstack_end(m);
+  return build_poly();
+}
+
+/*------------------------------------------------------------------------*/
+
+static void read_saved_design(const char * name, Saved_design & s) {
+  FILE * file = fopen(name, "r");
+  if (!file) die(err_incremental, "can not read saved remainders '%s'", name);
+
+  int ok = fscanf(file, "amulet-remainders 1 design %u %u %u %u %u %u",
+    &s.M, &s.NN, &s.a0, &s.ainc, &s.b0, &s.binc) == 6;
+  int sign, xors;
+  ok = ok && fscanf(file, "%d %d", &sign, &xors) == 2;
+  if (!ok || s.M < s.NN + 1) {
+    fclose(file);
+    die(err_incremental, "invalid saved remainders '%s'", name);
+  }
+  s.signed_mult = sign, s.xor_chain = xors;
+
+  s.ands.resize(s.M - 1 - s.NN);
+  for (size_t i = 0; ok && i < s.ands.size(); i++)
+    ok = fscanf(file, " and %u %u", &s.ands[i].first, &s.ands[i].second) == 2;
+  s.outputs.resize(s.NN);
+  for (unsigned i = 0; ok && i < s.NN; i++)
+    ok = fscanf(file, " output %u", &s.outputs[i]) == 1;
+
+  s.signatures.resize(s.NN);
+  s.remainders.resize(s.NN);
+  s.have_remainder.resize(s.NN);
+  for (unsigned k = 0; ok && k < s.NN; k++) {
+    unsigned i;
+    unsigned long long sig;
+    long long size;
+    ok = fscanf(file, " slice %u %llx %lld", &i, &sig, &size) == 3 &&
+      i < s.NN;
+    if (!ok) break;
+    s.signatures[i] = sig;
+    s.have_remainder[i] = size >= 0;
+    char buf[1 << 16];
+    if (!fgets(buf, sizeof buf, file)) ok = size <= 0;
+    for (long long j = 0; ok && j < size; j++) {
+      std::string line;
+      do {
+        ok = fgets(buf, sizeof buf, file) != 0;
+        if (ok) line += buf;
+      } while (ok && line.back() != '\n');
+      s.remainders[i] += line;
+    }
+  }
+  fclose(file);
+  if (!ok) die(err_incremental, "invalid saved remainders '%s'", name);
+}
+
+/*------------------------------------------------------------------------*/
+// Matches the gates of the current design with the gates of the saved
+// design, returns the saved id for each gate or unmatched | index
+static std::vector<uint64_t> match_gates(const Saved_design & s) {
+  std::vector<uint64_t> rename(num_gates);
+  for (unsigned i = 0; i < num_gates; i++) rename[i] = unmatched | i;
+  std::vector<bool> taken(s.M + s.NN - 1, 0);
+
+  auto match = [&](unsigned n, unsigned o) {
+    rename[n] = o;
+    taken[o] = 1;
+  };
+  for (unsigned k = 0; k < NN/2; k++) {
+    match(a0 + k*ainc, s.a0 + k*s.ainc);
+    match(b0 + k*binc, s.b0 + k*s.binc);
+  }
+  for (unsigned k = 0; k < NN; k++) match(M - 1 + k, s.M - 1 + k);
+
+  // saved literal of a literal of the current design, -1 if unmatched
+  auto saved_lit = [&](unsigned lit) -> int64_t {
+    if (lit < 2) return lit;
+    uint64_t id = rename[lit/2 - 1];
+    if (id & unmatched) return -1;
+    return 2*(id + 1) + (lit & 1);
+  };
+  auto is_saved_and = [&](unsigned lit) {
+    return lit/2 > s.NN && lit/2 < s.M;
+  };
+  auto saved_and = [&](unsigned lit) { return s.ands[lit/2 - 1 - s.NN]; };
+  auto and_key = [](uint64_t l0, uint64_t l1) {
+    return std::min(l0, l1) << 32 | std::max(l0, l1);
+  };
+
+  // bottom-up, gates with matched operands are matched by structural hash
+  std::unordered_map<uint64_t, unsigned> strash;
+  for (unsigned o = s.NN; o < s.M - 1; o++)
+    strash.emplace(and_key(s.ands[o - s.NN].first, s.ands[o - s.NN].second), o);
+  for (unsigned n = NN; n < M - 1; n++) {
+    aiger_and * and1 = is_model_and(2*(n + 1));
+    int64_t l0 = saved_lit(and1->rhs0), l1 = saved_lit(and1->rhs1);
+    if (l0 < 0 || l1 < 0) continue;
+    auto it = strash.find(and_key(l0, l1));
+    if (it != strash.end() && !taken[it->second]) match(n, it->second);
+  }
+  unsigned bottom_up = 0;
+  for (unsigned n = NN; n < M - 1; n++) bottom_up += !(rename[n] & unmatched);
+
+  // top-down from the outputs, gates at the same position are matched
+  std::vector<bool> visited(num_gates, 0);
+  std::deque<std::pair<unsigned, unsigned>> todo;
+  for (unsigned k = 0; k < NN; k++) todo.push_back({slit(k), s.outputs[k]});
+  while (!todo.empty()) {
+    unsigned nl = todo.front().first, ol = todo.front().second;
+    todo.pop_front();
+    if ((nl ^ ol) & 1) continue;
+    if (!is_model_and(aiger_strip(nl)) || !is_saved_and(ol)) continue;
+    unsigned n = nl/2 - 1, o = ol/2 - 1;
+    if (rename[n] & unmatched) {
+      if (taken[o]) continue;
+      match(n, o);
+    } else if (rename[n] != o) {
+      continue;
+    }
+    if (visited[n]) continue;
+    visited[n] = 1;
+
+    aiger_and * and1 = is_model_and(aiger_strip(nl));
+    unsigned n0 = and1->rhs0, n1 = and1->rhs1;
+    unsigned o0 = saved_and(ol).first, o1 = saved_and(ol).second;
+    bool cross;
+    if (saved_lit(n0) == o0 || saved_lit(n1) == o1) cross = 0;
+    else if (saved_lit(n0) == o1 || saved_lit(n1) == o0) cross = 1;
+    else
+      cross = (n0 & 1) != (o0 & 1);
+    todo.push_back({n0, cross ? o1 : o0});
+    todo.push_back({n1, cross ? o0 : o1});
+  }
+
+  unsigned total = 0;
+  for (unsigned n = NN; n < M - 1; n++) total += !(rename[n] & unmatched);
+  msg("matched %u of %u AND gates with the saved design (%u structurally)",
+    total, M - 1 - NN, bottom_up);
+  return rename;
+}
+
+/*------------------------------------------------------------------------*/
+// Determines the first slice to reduce from the saved design
+static Polynomial * reuse_saved_design(int & slice) {
+  Saved_design s;
+  read_saved_design(incremental_name, s);
+  if (s.NN != NN || s.signed_mult != signed_mult || s.xor_chain != xor_chain) {
+    msg("saved remainders '%s' do not fit, reducing all slices",
+      incremental_name);
+    return 0;
+  }
+
+  std::vector<uint64_t> rename = match_gates(s);
+  std::vector<int64_t> inverse(s.M + s.NN - 1, -1);
+  for (unsigned n = 0; n < num_gates; n++)
+    if (!(rename[n] & unmatched)) inverse[rename[n]] = n;
+
+  int affected = -1;
+  for (int i = NN - 1; i >= 0 && affected < 0; i--)
+    if (slice_signature(i, &rename) != s.signatures[i]) affected = i;
+  msg("highest affected slice is %i", affected);
+
+  // remainders of unaffected slices that can be renamed
+  std::vector<std::string> renamed(NN);
+  std::vector<bool> have(NN, 0);
+  for (int i = NN - 1; i > affected; i--)
+    have[i] = s.have_remainder[i] &&
+      rename_polynomial(s.remainders[i], inverse, renamed[i]);
+
+  // start below the lowest unaffected slice with a renamed remainder
+  int above = affected + 1;
+  while (above < static_cast<int>(NN) && !have[above]) above++;
+  if (above == static_cast<int>(NN)) {
+    msg("no saved remainder can be reused, reducing all slices");
+    return 0;
+  }
+
+  for (int i = NN - 1; i >= above; i--) {
+    if (!save_remainders_name || !have[i]) continue;
+    remainders[i] = renamed[i];
+    have_remainder[i] = 1;
+  }
+  slice = above - 1;
+  msg("reusing saved remainder after slice %i, skipping %i slices",
+    above, NN - above);
+  return decode_polynomial(renamed[above]);
+}
+
+/*------------------------------------------------------------------------*/
+
+Polynomial * init_incremental(int & slice) {
+  slice = NN - 1;
+  if (save_remainders_name) {
+    signatures.resize(NN);
+    for (unsigned i = 0; i < NN; i++) signatures[i] = slice_signature(i, 0);
+    remainders.assign(NN, std::string());
+    have_remainder.assign(NN, 0);
+  }
+  if (!incremental_name) return 0;
+  return reuse_saved_design(slice);
+}
+
+/*------------------------------------------------------------------------*/
+
+void save_slice_remainder(int slice, const Polynomial * rem) {
+  if (!save_remainders_name || !rem) return;
+  remainders[slice] = encode_polynomial(rem);
+  have_remainder[slice] = 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+void finish_incremental() {
+  if (!save_remainders_name) return;
+
+  std::string tmp = std::string(save_remainders_name) + ".tmp";
+  FILE * file = fopen(tmp.c_str(), "w");
+  if (!file) die(err_saving, "can not write remainders to '%s'", tmp.c_str());
+
+  fprintf(file, "amulet-remainders 1\n");
+  fprintf(file, "design %u %u %u %u %u %u %d %d\n",
+    M, NN, a0, ainc, b0, binc, signed_mult, xor_chain);
+  for (unsigned n = NN; n < M - 1; n++) {
+    aiger_and * and1 = is_model_and(2*(n + 1));
+    fprintf(file, "and %u %u\n", and1->rhs0, and1->rhs1);
+  }
+  for (unsigned k = 0; k < NN; k++) fprintf(file, "output %u\n", slit(k));
+  for (int i = NN - 1; i >= 0; i--) {
+    const std::string & rem = remainders[i];
+    long long size = have_remainder[i] ?
+      std::count(rem.begin(), rem.end(), '\n') : -1;
+    fprintf(file, "slice %d %016llx %lld\n", i,
+      static_cast<unsigned long long>(signatures[i]), size);
+    fputs(rem.c_str(), file);
+  }
+  if (fclose(file) || rename(tmp.c_str(), save_remainders_name)) {
+    unlink(tmp.c_str());
+    die(err_saving, "can not write remainders to '%s'", save_remainders_name);
+  }
+  msg("saved remainders to '%s'", save_remainders_name);
+
+  signatures.clear();
+  remainders.clear();
+  have_remainder.clear();
+}
@@ -0,0 +1,65 @@
+/*------------------------------------------------------------------------*/
+/*! \file incremental.h
+    \brief incremental re-verification of a changed AIG from the saved
+    remainders of a previous run
+
+  With save_remainders_name set, the reduction saves the AND gates of the
+  AIG, a signature of the gate constraints of every slice and the
+  remainder after every slice. The file is self-contained, so the
+  previous AIG is not needed for the next run.
+
+  With incremental_name set, the gates of the new AIG are matched with the
+  gates of the saved AIG, bottom-up by structural hashing from the inputs
+  and top-down from the outputs, which also pairs gates whose function
+  has been changed. A slice is affected if the signature of its gate
+  constraints, with variables renamed to the matched saved gates, differs
+  from the saved one. The reduction starts at the highest affected slice
+  with the saved remainder of the slice above, renamed to the new gates.
+  If this remainder contains a gate without match, the reduction starts
+  at a higher slice or from scratch.
+
+  Both are only supported in '-verify'.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_INCREMENTAL_H_
+#define AMULET2_SRC_INCREMENTAL_H_
+/*------------------------------------------------------------------------*/
+#include "polynomial.h"
+/*------------------------------------------------------------------------*/
+// / Name of the file the remainders are saved to, 0 if not saving
+extern thread_local const char * save_remainders_name;
+
+// / Name of the saved remainders of a previous run, 0 if not incremental
+extern thread_local const char * incremental_name;
+
+/**
+    Computes the signatures of the slices and, if incremental_name is set,
+    determines the slice where the reduction starts. Has to be called
+    before reducing.
+
+    @param slice int &, set to the slice that is reduced first, -1 if no
+                 slice is affected
+
+    @return Polynomial*, remainder after reducing the slices above slice,
+            0 if the reduction starts from scratch
+*/
+Polynomial * init_incremental(int & slice);
+
+/**
+    Records the remainder after reducing by the slice, if
+    save_remainders_name is set
+
+    @param slice integer
+    @param rem const Polynomial*
+*/
+void save_slice_remainder(int slice, const Polynomial * rem);
+
+/**
+    Writes the saved remainders and frees the incremental state
+*/
+void finish_incremental();
+
+#endif  // AMULET2_SRC_INCREMENTAL_H_
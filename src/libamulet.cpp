@@ -0,0 +1,134 @@
+/*------------------------------------------------------------------------*/
+/*! \file libamulet.cpp
+    \brief C++ interface of the library 'libamulet'
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include "libamulet.h"
+/*------------------------------------------------------------------------*/
+
+const char * amulet_status_name(Amulet_status status) {
+  switch (status) {
+    case amulet_parsed:          return "parsed";
+    case amulet_correct:         return "correct";
+    case amulet_incorrect:       return "incorrect";
+    case amulet_substituted:     return "substituted";
+    case amulet_not_substituted: return "not substituted";
+    default:                     return "failed";
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Calls the method of the context and converts its outcome, an
+    Amulet_error is returned as status amulet_failed
+
+    @param context Verification_context &
+    @param call callable returning the status of the method
+
+    @return Amulet_result
+*/
+template<class Call>
+static Amulet_result run(Verification_context & context, Call call) {
+  Amulet_result res;
+  double start = wall_clock_time();
+  try {
+    res.status = call();
+  } catch (const Amulet_error & e) {
+    res.status = amulet_failed;
+    res.error_code = e.get_error_code();
+    res.error_message = e.what();
+  }
+  if (res.status == amulet_correct || res.status == amulet_incorrect) {
+    res.input_names = context.get_input_names();
+    res.counter_examples = context.get_counter_examples();
+  }
+  res.wall_time = wall_clock_time() - start;
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+Amulet_result amulet_parse(Verification_context & context,
+                           const char * input_name) {
+  return run(context, [&]() -> Amulet_status {
+    context.parse(input_name);
+    return amulet_parsed;
+  });
+}
+
+/*------------------------------------------------------------------------*/
+
+Amulet_result amulet_parse(Verification_context & context,
+                           const char * buffer, size_t size) {
+  return run(context, [&]() -> Amulet_status {
+    context.parse(buffer, size);
+    return amulet_parsed;
+  });
+}
+
+/*------------------------------------------------------------------------*/
+
+Amulet_result amulet_parse(Verification_context & context, const aiger * aig) {
+  return run(context, [&]() -> Amulet_status {
+    context.parse(aig);
+    return amulet_parsed;
+  });
+}
+
+/*------------------------------------------------------------------------*/
+
+Amulet_result amulet_verify(Verification_context & context) {
+  return run(context, [&]() -> Amulet_status {
+    return context.verify() ? amulet_correct : amulet_incorrect;
+  });
+}
+
+/*------------------------------------------------------------------------*/
+
+Amulet_result amulet_certify(Verification_context & context,
+  const char * out_f1, const char * out_f2, const char * out_f3) {
+  return run(context, [&]() -> Amulet_status {
+    return context.certify(out_f1, out_f2, out_f3) ?
+      amulet_correct : amulet_incorrect;
+  });
+}
+
+/*------------------------------------------------------------------------*/
+
+Amulet_result amulet_substitute(Verification_context & context,
+  const char * out_f1, const char * out_f2) {
+  return run(context, [&]() -> Amulet_status {
+    return context.substitution(out_f1, out_f2) ?
+      amulet_substituted : amulet_not_substituted;
+  });
+}
+
+/*------------------------------------------------------------------------*/
+
+Amulet_result amulet_verify(const aiger * aig,
+                            const Verification_options & options) {
+  Verification_context context(options);
+  Amulet_result res = amulet_parse(context, aig);
+  if (res.status == amulet_failed) return res;
+  double parse_time = res.wall_time;
+  res = amulet_verify(context);
+  res.wall_time += parse_time;
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+Amulet_result amulet_verify(const char * buffer, size_t size,
+                            const Verification_options & options) {
+  Verification_context context(options);
+  Amulet_result res = amulet_parse(context, buffer, size);
+  if (res.status == amulet_failed) return res;
+  double parse_time = res.wall_time;
+  res = amulet_verify(context);
+  res.wall_time += parse_time;
+  return res;
+}
@@ -0,0 +1,161 @@
+/*------------------------------------------------------------------------*/
+/*! \file libamulet.h
+    \brief C++ interface of the library 'libamulet'
+
+  The entry points wrap the methods of a Verification_context and return
+  the outcome as an Amulet_result instead of an exit code and messages.
+  Errors do not exit the program, they are returned with status
+  amulet_failed. Designs can be given as file name, as buffer holding an
+  AIGER file, or as 'aiger*' of the AIGER library. For designs given in
+  memory counter examples are only returned and not written to a file.
+
+  Messages are printed to stdout unless 'quiet' is set in the options of
+  the context, error messages are always printed to stderr as well. The
+  library does not install signal handlers.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_LIBAMULET_H_
+#define AMULET2_SRC_LIBAMULET_H_
+/*------------------------------------------------------------------------*/
+#include <string>
+#include <vector>
+
+#include "verification_context.h"
+/*------------------------------------------------------------------------*/
+
+// / Outcome of an entry point of the library
+enum Amulet_status {
+  amulet_parsed,           // /< the design has been parsed
+  amulet_correct,          // /< the multiplier is correct
+  amulet_incorrect,        // /< the multiplier is incorrect
+  amulet_substituted,      // /< the final stage adder has been substituted
+  amulet_not_substituted,  // /< no final stage adder has been found
+  amulet_failed            // /< an error occurred
+};
+
+/** \struct Amulet_result
+    Result of an entry point of the library
+*/
+struct Amulet_result {
+  Amulet_status status = amulet_failed;  // /< outcome
+  int error_code = 0;                    // /< code of the error, as exit code
+  std::string error_message;             // /< message of the error
+
+  // / names of the inputs of the verified design
+  std::vector<std::string> input_names;
+
+  // / counter examples of an incorrect multiplier, ordered as the inputs
+  std::vector<std::vector<bool>> counter_examples;
+
+  double wall_time = 0;  // /< elapsed wall clock time in seconds
+};
+
+/**
+    Returns a readable name of the status
+
+    @param status Amulet_status
+
+    @return const char*
+*/
+const char * amulet_status_name(Amulet_status status);
+
+/**
+    Reads the AIG from a file
+
+    @param context Verification_context &
+    @param input_name char * name of the input file
+
+    @return Amulet_result with status amulet_parsed or amulet_failed
+*/
+Amulet_result amulet_parse(Verification_context & context,
+                           const char * input_name);
+
+/**
+    Reads the AIG from a buffer holding an AIGER file in ASCII or binary
+    format
+
+    @param context Verification_context &
+    @param buffer const char* contents of the AIGER file
+    @param size size_t number of bytes in buffer
+
+    @return Amulet_result with status amulet_parsed or amulet_failed
+*/
+Amulet_result amulet_parse(Verification_context & context,
+                           const char * buffer, size_t size);
+
+/**
+    Copies the AIG
+
+    @param context Verification_context &
+    @param aig const aiger*, which is not modified
+
+    @return Amulet_result with status amulet_parsed or amulet_failed
+*/
+Amulet_result amulet_parse(Verification_context & context, const aiger * aig);
+
+/**
+    Verifies the parsed design as in '-verify'
+
+    @param context Verification_context &
+
+    @return Amulet_result with status amulet_correct, amulet_incorrect or
+            amulet_failed
+*/
+Amulet_result amulet_verify(Verification_context & context);
+
+/**
+    Verifies the parsed design and writes the certificate as in '-certify'
+
+    @param context Verification_context &
+    @param out_f1 name of the gate constraints file
+    @param out_f2 name of the proof file
+    @param out_f3 name of the specification file
+
+    @return Amulet_result with status amulet_correct, amulet_incorrect or
+            amulet_failed
+*/
+Amulet_result amulet_certify(Verification_context & context,
+  const char * out_f1, const char * out_f2, const char * out_f3);
+
+/**
+    Substitutes the final stage adder of the parsed design as in
+    '-substitute'
+
+    @param context Verification_context &
+    @param out_f1 name of the CNF miter file
+    @param out_f2 name of the rewritten AIG file
+
+    @return Amulet_result with status amulet_substituted,
+            amulet_not_substituted or amulet_failed, with error code 53
+            if simulation distinguishes the adder from its replacement
+*/
+Amulet_result amulet_substitute(Verification_context & context,
+  const char * out_f1, const char * out_f2);
+
+/**
+    Parses and verifies the AIG in a temporary context
+
+    @param aig const aiger*, which is not modified
+    @param options const Verification_options &
+
+    @return Amulet_result
+*/
+Amulet_result amulet_verify(const aiger * aig,
+  const Verification_options & options = Verification_options());
+
+/**
+    Parses and verifies the AIGER file in the buffer in a temporary context
+
+    @param buffer const char* contents of the AIGER file
+    @param size size_t number of bytes in buffer
+    @param options const Verification_options &
+
+    @return Amulet_result
+*/
+Amulet_result amulet_verify(const char * buffer, size_t size,
+  const Verification_options & options = Verification_options());
+
+#endif  // AMULET2_SRC_LIBAMULET_H_
@@ -0,0 +1,371 @@
+/*------------------------------------------------------------------------*/
+/*! \file miter_simulation.cpp
+    \brief bit-parallel simulation of the miter generated in '-substitute'
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "miter_simulation.h"
+/*------------------------------------------------------------------------*/
+// Global variable
+thread_local bool miter_simulation = 0;
+/*------------------------------------------------------------------------*/
+// Local variables
+
+// / number of 64-bit words of random and corner patterns per variable
+static const unsigned sim_words = 64;
+
+// / maximal support of two candidates that is checked exhaustively
+static const unsigned max_support = 12;
+
+// / maximal number of candidates that are checked for each and
+static const unsigned max_candidates = 8;
+
+// / simulation signatures, sim_words words for each variable of the miter
+static thread_local std::vector<uint64_t> signatures;
+/*------------------------------------------------------------------------*/
+
+/**
+    Returns the simulation values of a literal in the given table
+
+    @param table std::vector<uint64_t> with words entries per variable
+    @param words unsigned number of words per variable
+    @param lit unsigned aiger literal
+    @param w unsigned word
+
+    @return uint64_t simulated values of lit for 64 patterns
+*/
+static uint64_t lit_word(
+  const std::vector<uint64_t> & table, unsigned words, unsigned lit,
+  unsigned w) {
+  uint64_t res = table[aiger_lit2var(lit) * words + w];
+  return aiger_sign(lit) ? ~res : res;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Simulates the and of the miter with index i on all words of the table
+
+    @param table std::vector<uint64_t> with words entries per variable
+    @param words unsigned number of words per variable
+    @param i unsigned index of the and in the miter
+*/
+static void simulate_and(
+  std::vector<uint64_t> & table, unsigned words, unsigned i) {
+  const aiger_and & and1 = miter->ands[i];
+  uint64_t * lhs = &table[aiger_lit2var(and1.lhs) * words];
+  for (unsigned w = 0; w < words; w++)
+    lhs[w] = lit_word(table, words, and1.rhs0, w) &
+             lit_word(table, words, and1.rhs1, w);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Random number generator (xorshift64*) used for the patterns
+
+    @param state uint64_t &
+
+    @return uint64_t random number
+*/
+static uint64_t next_random(uint64_t & state) {
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 2685821657736338717ull;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Fills the signatures of the inputs. The first patterns are the corner
+    patterns: all zero, all one, one input set (walking one) and all but one
+    input set (walking zero). The remaining patterns are random.
+*/
+static void init_input_patterns() {
+  unsigned num_inputs = miter->num_inputs;
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+
+  for (unsigned i = 0; i < num_inputs; i++) {
+    uint64_t * sig = &signatures[aiger_lit2var(miter->inputs[i].lit)*sim_words];
+    for (unsigned w = 0; w < sim_words; w++) sig[w] = next_random(state);
+
+    unsigned num_corners = std::min(2 + 2*num_inputs, 64*sim_words);
+    for (unsigned p = 0; p < num_corners; p++) {
+      bool val;
+      if (p < 2) val = p;
+      else if (p < 2 + num_inputs) val = (p - 2 == i);
+      else
+        val = (p - 2 - num_inputs != i);
+
+      uint64_t bit = static_cast<uint64_t>(1) << (p % 64);
+      if (val) sig[p / 64] |= bit;
+      else
+        sig[p / 64] &= ~bit;
+    }
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Prints the input values of the given pattern
+
+    @param p unsigned pattern
+*/
+static void print_pattern(unsigned p) {
+  std::string line;
+  for (unsigned i = 0; i < miter->num_inputs; i++) {
+    unsigned lit = miter->inputs[i].lit;
+    uint64_t w = signatures[aiger_lit2var(lit) * sim_words + p / 64];
+    const char * name = miter->inputs[i].name;
+    char buf[32];
+    if (!name) {
+      snprintf(buf, sizeof buf, "i%u", i);
+      name = buf;
+    }
+    line += name;
+    line += ((w >> (p % 64)) & 1) ? "=1 " : "=0 ";
+  }
+  msg("distinguishing pattern: %s", line.c_str());
+}
+
+/*------------------------------------------------------------------------*/
+
+bool simulate_miter() {
+  assert(miter->num_outputs == 1);
+  msg("simulate miter on %u patterns", 64*sim_words);
+
+  aiger_reencode(miter);
+  signatures.assign((miter->maxvar + 1) * sim_words, 0);
+
+  init_input_patterns();
+  for (unsigned i = 0; i < miter->num_ands; i++)
+    simulate_and(signatures, sim_words, i);
+
+  unsigned out = miter->outputs[0].lit;
+  for (unsigned w = 0; w < sim_words; w++) {
+    uint64_t res = lit_word(signatures, sim_words, out, w);
+    if (!res) continue;
+
+    unsigned p = 64*w;
+    while (!(res & 1)) { res >>= 1; p++; }
+    msg("simulation found a pattern that distinguishes the adders");
+    print_pattern(p);
+    return 0;
+  }
+
+  msg("simulation found no distinguishing pattern");
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Computes for each variable the sorted list of inputs in its cone,
+    variables with more than max_support inputs are marked as large.
+
+    @param support std::vector<std::vector<unsigned>> &
+    @param large std::vector<bool> &
+*/
+static void compute_support(
+  std::vector<std::vector<unsigned>> & support, std::vector<bool> & large) {
+  support.assign(miter->maxvar + 1, std::vector<unsigned>());
+  large.assign(miter->maxvar + 1, 0);
+
+  for (unsigned i = 0; i < miter->num_inputs; i++)
+    support[aiger_lit2var(miter->inputs[i].lit)].push_back(i);
+
+  for (unsigned i = 0; i < miter->num_ands; i++) {
+    const aiger_and & and1 = miter->ands[i];
+    unsigned lhs = aiger_lit2var(and1.lhs);
+    unsigned r0 = aiger_lit2var(and1.rhs0), r1 = aiger_lit2var(and1.rhs1);
+    if (large[r0] || large[r1]) { large[lhs] = 1; continue; }
+
+    std::vector<unsigned> & s = support[lhs];
+    std::set_union(support[r0].begin(), support[r0].end(),
+      support[r1].begin(), support[r1].end(), std::back_inserter(s));
+    if (s.size() > max_support) {
+      large[lhs] = 1;
+      std::vector<unsigned>().swap(s);
+    }
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Checks whether the literals a and b are equivalent by simulating their
+    cones on all assignments of the given inputs.
+
+    @param a unsigned aiger literal
+    @param b unsigned aiger literal
+    @param inputs const std::vector<unsigned> & sorted indices of the inputs
+    @param table std::vector<uint64_t> & scratch table, large enough to
+                 store 2^(max_support-6) words per variable
+
+    @return true if a and b are equivalent
+*/
+static bool equivalent_by_exhaustive_simulation(
+  unsigned a, unsigned b, const std::vector<unsigned> & inputs,
+  std::vector<uint64_t> & table) {
+  static const uint64_t masks[6] = {
+    0xaaaaaaaaaaaaaaaaull, 0xccccccccccccccccull, 0xf0f0f0f0f0f0f0f0ull,
+    0xff00ff00ff00ff00ull, 0xffff0000ffff0000ull, 0xffffffff00000000ull };
+
+  unsigned k = inputs.size();
+  unsigned words = k > 6 ? 1u << (k - 6) : 1;
+  for (unsigned w = 0; w < words; w++) table[w] = 0;
+
+  for (unsigned j = 0; j < k; j++) {
+    unsigned v = aiger_lit2var(miter->inputs[inputs[j]].lit);
+    for (unsigned w = 0; w < words; w++) {
+      if (j < 6) table[v * words + w] = masks[j];
+      else
+        table[v * words + w] = ((w >> (j - 6)) & 1) ? ~0ull : 0;
+    }
+  }
+
+  // collect the cone, after reencoding ands are in topological order
+  static thread_local std::vector<unsigned> cone, stack, seen;
+  static thread_local unsigned epoch = 0;
+  if (seen.size() != miter->maxvar + 1 || !++epoch) {
+    seen.assign(miter->maxvar + 1, 0);
+    epoch = 1;
+  }
+  cone.clear();
+  stack.push_back(aiger_lit2var(a));
+  stack.push_back(aiger_lit2var(b));
+  unsigned first_and = miter->num_inputs + 1;
+  while (!stack.empty()) {
+    unsigned v = stack.back();
+    stack.pop_back();
+    if (v < first_and || seen[v] == epoch) continue;
+    seen[v] = epoch;
+    cone.push_back(v - first_and);
+    const aiger_and & and1 = miter->ands[v - first_and];
+    stack.push_back(aiger_lit2var(and1.rhs0));
+    stack.push_back(aiger_lit2var(and1.rhs1));
+  }
+  std::sort(cone.begin(), cone.end());
+  for (size_t i = 0; i < cone.size(); i++) simulate_and(table, words, cone[i]);
+
+  for (unsigned w = 0; w < words; w++)
+    if (lit_word(table, words, a, w) != lit_word(table, words, b, w))
+      return 0;
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Computes the hash of the signature of variable v, normalized such that
+    the first pattern evaluates to false
+
+    @param v unsigned variable
+
+    @return uint64_t hash value
+*/
+static uint64_t signature_hash(unsigned v) {
+  const uint64_t * sig = &signatures[v * sim_words];
+  uint64_t flip = (sig[0] & 1) ? ~0ull : 0, res = 0;
+  for (unsigned w = 0; w < sim_words; w++)
+    res = (res ^ (sig[w] ^ flip)) * 1099511628211ull + w;
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Checks whether the signatures of the variables u and v are equal up to
+    negation
+
+    @param u unsigned variable
+    @param v unsigned variable
+
+    @return true if the signatures match
+*/
+static bool same_signature(unsigned u, unsigned v) {
+  const uint64_t * su = &signatures[u * sim_words];
+  const uint64_t * sv = &signatures[v * sim_words];
+  uint64_t flip = ((su[0] ^ sv[0]) & 1) ? ~0ull : 0;
+  for (unsigned w = 0; w < sim_words; w++)
+    if (su[w] != (sv[w] ^ flip)) return 0;
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+void fraig_miter() {
+  assert(signatures.size() == (miter->maxvar + 1) * sim_words);
+
+  std::vector<std::vector<unsigned>> support;
+  std::vector<bool> large;
+  compute_support(support, large);
+
+  // maps variables to their representative literal
+  std::vector<unsigned> repr(miter->maxvar + 1);
+  for (unsigned v = 0; v <= miter->maxvar; v++) repr[v] = aiger_var2lit(v);
+
+  std::unordered_map<uint64_t, std::vector<unsigned>> classes;
+  classes[signature_hash(0)].push_back(0);
+  for (unsigned i = 0; i < miter->num_inputs; i++) {
+    unsigned v = aiger_lit2var(miter->inputs[i].lit);
+    classes[signature_hash(v)].push_back(v);
+  }
+
+  std::vector<uint64_t> table((miter->maxvar + 1) << (max_support - 6));
+  std::vector<unsigned> inputs;
+  unsigned merged = 0;
+
+  for (unsigned i = 0; i < miter->num_ands; i++) {
+    unsigned v = aiger_lit2var(miter->ands[i].lhs);
+    if (large[v]) continue;
+
+    std::vector<unsigned> & cands = classes[signature_hash(v)];
+    unsigned checked = 0;
+    for (size_t j = 0; j < cands.size() && checked < max_candidates; j++) {
+      unsigned u = cands[j];
+      if (!same_signature(u, v)) continue;
+
+      inputs.clear();
+      std::set_union(support[u].begin(), support[u].end(),
+        support[v].begin(), support[v].end(), std::back_inserter(inputs));
+      if (inputs.size() > max_support) continue;
+      checked++;
+
+      unsigned lit = aiger_var2lit(u);
+      if ((signatures[u * sim_words] ^ signatures[v * sim_words]) & 1)
+        lit = aiger_not(lit);
+      if (!equivalent_by_exhaustive_simulation(
+            lit, aiger_var2lit(v), inputs, table)) continue;
+
+      repr[v] = lit;
+      merged++;
+      break;
+    }
+    if (repr[v] == aiger_var2lit(v)) cands.push_back(v);
+  }
+
+  // redirect the fanins, merged ands are no longer referenced
+  for (unsigned i = 0; i < miter->num_ands; i++) {
+    aiger_and & and1 = miter->ands[i];
+    and1.rhs0 = repr[aiger_lit2var(and1.rhs0)] ^ aiger_sign(and1.rhs0);
+    and1.rhs1 = repr[aiger_lit2var(and1.rhs1)] ^ aiger_sign(and1.rhs1);
+  }
+  unsigned & out = miter->outputs[0].lit;
+  out = repr[aiger_lit2var(out)] ^ aiger_sign(out);
+
+  msg("fraiging merged %u of %u miter ands", merged, miter->num_ands);
+  std::vector<uint64_t>().swap(signatures);
+}
@@ -0,0 +1,44 @@
+/*------------------------------------------------------------------------*/
+/*! \file miter_simulation.h
+    \brief bit-parallel simulation of the miter generated in '-substitute'
+
+  Before the miter is written as CNF it can be simulated on 64 patterns
+  per machine word, using corner patterns (all zero, all one, walking one
+  and walking zero) followed by random patterns. A pattern on which the
+  miter evaluates to true distinguishes the original and the rewritten
+  adder and is reported immediately.
+
+  Otherwise the simulation signatures are used to find candidates for
+  equivalent ands in the miter. Candidates whose combined support is small
+  enough are checked by exhaustive simulation and merged, which shrinks the
+  generated CNF.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_MITER_SIMULATION_H_
+#define AMULET2_SRC_MITER_SIMULATION_H_
+/*------------------------------------------------------------------------*/
+#include "aig.h"
+#include "signal_statistics.h"
+/*------------------------------------------------------------------------*/
+// / set to true to simulate and fraig the miter in '-substitute'
+extern thread_local bool miter_simulation;
+
+/**
+    Simulates the miter on corner and random patterns and prints the
+    first pattern that distinguishes both adders.
+
+    @return true if no distinguishing pattern was found
+*/
+bool simulate_miter();
+
+/**
+    Merges ands of the miter that have the same simulation signature and
+    are proven equivalent by exhaustive simulation of their support.
+    Requires that simulate_miter() has been called before.
+*/
+void fraig_miter();
+
+#endif  // AMULET2_SRC_MITER_SIMULATION_H_
@@ -9,8 +9,12 @@
 /*------------------------------------------------------------------------*/
 #include "monomial.h"
 /*------------------------------------------------------------------------*/
+// Global variable
+thread_local int64_t num_monomials = 0;
+/*------------------------------------------------------------------------*/
 
 Monomial::Monomial(mpz_t _c, Term * _t): ref(1) {
+  num_monomials++;
   mpz_init_set(coeff, _c);
   if (mpz_sgn(_c) == 0) term = 0;
   else  term = _t;
@@ -32,6 +36,7 @@ Monomial * Monomial::copy() {
 
 Monomial::~Monomial() {
   assert(ref == 0);
+  num_monomials--;
 
   mpz_clear(coeff);
   deallocate_term(term);
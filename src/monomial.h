@@ -14,6 +14,9 @@
 
 #include "term.h"
 /*------------------------------------------------------------------------*/
+// / number of monomials allocated minus deallocated by the calling thread
+extern thread_local int64_t num_monomials;
+/*------------------------------------------------------------------------*/
 
 /** \class Monomial
     This class is used to represent monomials in a polynomial.
@@ -50,6 +53,12 @@ class Monomial {
   */
   Term * get_term_copy()  const {return term->copy();}
 
+  /** Setter for member term, the previous term is not released
+
+      @param t Term*
+  */
+  void set_term(Term * t) {term = t;}
+
   /** Returns the size fo the term
 
       @return unsigned, the size of the term
@@ -0,0 +1,453 @@
+/*------------------------------------------------------------------------*/
+/*! \file multiplier_simulation.cpp
+    \brief bit-parallel simulation of the multiplier before the reduction
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "multiplier_simulation.h"
+/*------------------------------------------------------------------------*/
+// Global variable
+thread_local bool multiplier_simulation = 0;
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_writing = 111; // cannot write to
+/*------------------------------------------------------------------------*/
+// Local variables
+
+// / number of 64-bit words simulated at once, i.e. 256 patterns
+static const unsigned sim_words = 4;
+
+// / number of simulation rounds
+static const unsigned sim_rounds = 16;
+
+// / maximal number of simulation rounds to search for further counter examples
+static const unsigned cex_rounds = 1024;
+
+// / number of structured operand values used in all combinations
+static const unsigned num_base_operands = 9;
+
+// / simulation values, sim_words words for each variable of the AIG
+static thread_local std::vector<uint64_t> values;
+
+// / and variables of the AIG in topological order
+static thread_local std::vector<unsigned> and_order;
+/*------------------------------------------------------------------------*/
+
+/**
+    Returns the aiger variable of the i'th bit of input vector a
+
+    @param i unsigned
+
+    @return unsigned variable
+*/
+static unsigned a_var(unsigned i) { return a0 + i*ainc + 1; }
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Returns the aiger variable of the i'th bit of input vector b
+
+    @param i unsigned
+
+    @return unsigned variable
+*/
+static unsigned b_var(unsigned i) { return b0 + i*binc + 1; }
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Returns the simulated values of a literal for the w'th word
+
+    @param lit unsigned aiger literal
+    @param w unsigned word
+
+    @return uint64_t
+*/
+static uint64_t lit_word(unsigned lit, unsigned w) {
+  uint64_t res = values[aiger_lit2var(lit) * sim_words + w];
+  return aiger_sign(lit) ? ~res : res;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Computes an order of the and variables in which every and comes after
+    its inputs. Usually the AIG is already ordered this way.
+*/
+static void init_and_order() {
+  and_order.clear();
+  bool sorted = 1;
+  for (unsigned v = NN+1; sorted && v < M; v++) {
+    aiger_and * and1 = is_model_and(aiger_var2lit(v));
+    sorted = aiger_lit2var(and1->rhs0) < v && aiger_lit2var(and1->rhs1) < v;
+  }
+
+  if (sorted) {
+    for (unsigned v = NN+1; v < M; v++) and_order.push_back(v);
+    return;
+  }
+
+  std::vector<char> mark(M, 0);
+  std::vector<unsigned> stack;
+  for (unsigned v = NN+1; v < M; v++) {
+    stack.push_back(v);
+    while (!stack.empty()) {
+      unsigned u = stack.back();
+      if (u <= NN || mark[u] == 2) { stack.pop_back(); continue; }
+      aiger_and * and1 = is_model_and(aiger_var2lit(u));
+      if (mark[u] == 1) {
+        mark[u] = 2;
+        and_order.push_back(u);
+        stack.pop_back();
+        continue;
+      }
+      mark[u] = 1;
+      stack.push_back(aiger_lit2var(and1->rhs0));
+      stack.push_back(aiger_lit2var(and1->rhs1));
+    }
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Returns bit i of a structured operand value of width n.
+    Kinds below num_base_operands are zero, one, all ones, the alternating
+    and grouped bit patterns that trigger the different booth encodings and
+    the maximal and minimal signed values. Larger kinds are walking ones
+    followed by walking zeros.
+
+    @param kind unsigned
+    @param i unsigned bit
+    @param n unsigned width of the operand
+
+    @return bit value
+*/
+static bool operand_bit(unsigned kind, unsigned i, unsigned n) {
+  switch (kind) {
+    case 0: return 0;
+    case 1: return i == 0;
+    case 2: return 1;
+    case 3: return i & 1;
+    case 4: return !(i & 1);
+    case 5: return (i >> 1) & 1;
+    case 6: return i % 3 != 0;
+    case 7: return i < n-1;
+    case 8: return i == n-1;
+    default: break;
+  }
+  kind -= num_base_operands;
+  return kind < n ? i == kind : i != kind - n;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Returns the number of structured patterns for operands of width n
+
+    @param n unsigned
+
+    @return unsigned
+*/
+static unsigned num_structured_patterns(unsigned n) {
+  return num_base_operands * num_base_operands + 4*n;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Determines the operand kinds of the structured pattern p. All pairs of
+    base operands are followed by walking ones and zeros in one operand
+    combined with all ones in the other.
+
+    @param p unsigned pattern
+    @param n unsigned width of the operands
+    @param ka unsigned &, kind of operand a
+    @param kb unsigned &, kind of operand b
+*/
+static void structured_pattern(
+  unsigned p, unsigned n, unsigned & ka, unsigned & kb) {
+  unsigned base = num_base_operands * num_base_operands;
+  if (p < base) {
+    ka = p / num_base_operands;
+    kb = p % num_base_operands;
+    return;
+  }
+  p -= base;
+  unsigned walk = num_base_operands + p % (2*n);
+  if (p < 2*n) ka = walk, kb = 2;
+  else
+    ka = 2, kb = walk;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Random number generator (xorshift64*) used for the patterns
+
+    @param state uint64_t &
+
+    @return uint64_t random number
+*/
+static uint64_t next_random(uint64_t & state) {
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 2685821657736338717ull;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Assigns the input values of the given round
+
+    @param round unsigned
+    @param state uint64_t & state of the random number generator
+*/
+static void init_inputs(unsigned round, uint64_t & state) {
+  for (unsigned v = 1; v <= NN; v++)
+    for (unsigned w = 0; w < sim_words; w++)
+      values[v * sim_words + w] = next_random(state);
+
+  unsigned n = NN/2, first = round * 64 * sim_words;
+  unsigned last = num_structured_patterns(n);
+  for (unsigned p = first; p < last && p < first + 64 * sim_words; p++) {
+    unsigned ka, kb, w = (p - first) / 64;
+    uint64_t bit = static_cast<uint64_t>(1) << (p % 64);
+    structured_pattern(p, n, ka, kb);
+    for (unsigned i = 0; i < n; i++) {
+      uint64_t & va = values[a_var(i) * sim_words + w];
+      uint64_t & vb = values[b_var(i) * sim_words + w];
+      va = operand_bit(ka, i, n) ? va | bit : va & ~bit;
+      vb = operand_bit(kb, i, n) ? vb | bit : vb & ~bit;
+    }
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Computes the product of a and b modulo 2^NN on all words, where a and b
+    are sign-extended for signed multipliers.
+
+    @param prod std::vector<uint64_t> &, NN*sim_words words
+*/
+static void reference_product(std::vector<uint64_t> & prod) {
+  unsigned n = NN/2;
+  std::vector<uint64_t> a(NN * sim_words), b(NN * sim_words);
+  for (unsigned i = 0; i < NN; i++) {
+    for (unsigned w = 0; w < sim_words; w++) {
+      if (i < n) {
+        a[i*sim_words + w] = values[a_var(i) * sim_words + w];
+        b[i*sim_words + w] = values[b_var(i) * sim_words + w];
+      } else if (signed_mult) {
+        a[i*sim_words + w] = values[a_var(n-1) * sim_words + w];
+        b[i*sim_words + w] = values[b_var(n-1) * sim_words + w];
+      } else {
+        a[i*sim_words + w] = b[i*sim_words + w] = 0;
+      }
+    }
+  }
+
+  prod.assign(NN * sim_words, 0);
+  for (unsigned i = 0; i < NN; i++) {
+    uint64_t carry[sim_words] = {0};
+    for (unsigned k = i; k < NN; k++) {
+      for (unsigned w = 0; w < sim_words; w++) {
+        uint64_t pp = a[(k-i)*sim_words + w] & b[i*sim_words + w];
+        uint64_t & s = prod[k*sim_words + w];
+        uint64_t t = s ^ pp;
+        uint64_t c = (s & pp) | (carry[w] & t);
+        s = t ^ carry[w];
+        carry[w] = c;
+      }
+    }
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Simulates all ands and compares the outputs with the reference product
+
+    @param diff uint64_t[sim_words], set to the patterns with a mismatch
+*/
+static void simulate_round(uint64_t * diff) {
+  for (size_t j = 0; j < and_order.size(); j++) {
+    unsigned v = and_order[j];
+    aiger_and * and1 = is_model_and(aiger_var2lit(v));
+    for (unsigned w = 0; w < sim_words; w++)
+      values[v * sim_words + w] =
+        lit_word(and1->rhs0, w) & lit_word(and1->rhs1, w);
+  }
+
+  static thread_local std::vector<uint64_t> prod;
+  reference_product(prod);
+
+  for (unsigned w = 0; w < sim_words; w++) {
+    diff[w] = 0;
+    for (unsigned k = 0; k < NN; k++)
+      diff[w] |= lit_word(slit(k), w) ^ prod[k*sim_words + w];
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Returns the input values of pattern p in the order of the AIG inputs
+
+    @param p unsigned pattern in the current round
+
+    @return std::vector<bool> with NN entries
+*/
+static std::vector<bool> get_pattern(unsigned p) {
+  std::vector<bool> res(NN);
+  uint64_t bit = static_cast<uint64_t>(1) << (p % 64);
+  for (unsigned i = 0; i < NN; i++)
+    res[i] = values[(i+1) * sim_words + p / 64] & bit;
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Allocates the simulation values and computes the order of the ands
+*/
+static void init_simulation() {
+  values.assign(M * sim_words, 0);
+  init_and_order();
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Deallocates the simulation values and the order of the ands
+*/
+static void reset_simulation() {
+  std::vector<uint64_t>().swap(values);
+  std::vector<unsigned>().swap(and_order);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Prints the counter example given by pattern p and writes it to the
+    counter example file
+
+    @param p unsigned pattern in the current round
+    @param inp_f name of the input file
+    @param write_cex bool, whether the counter example file is written
+*/
+static void report_mismatch(unsigned p, const char * inp_f, bool write_cex) {
+  std::vector<bool> cex = get_pattern(p);
+
+  msg("");
+  msg("COUNTER EXAMPLE IS: ");
+  FILE * witness_file = 0;
+  std::string witness_name;
+  if (write_cex) {
+    witness_name = witness_file_name(inp_f);
+    if (!(witness_file = fopen(witness_name.c_str(), "w")))
+      die(err_writing, "cannot write output to '%s'", witness_name.c_str());
+  }
+
+  write_witness_vector(cex, witness_file);
+
+  if (!write_cex) return;
+  fprintf(witness_file, ".");
+  fclose(witness_file);
+  print_witness_note(inp_f, witness_name.c_str());
+}
+
+/*------------------------------------------------------------------------*/
+
+bool simulate_multiplier(const char * inp_f, bool write_cex) {
+  msg("simulating %u patterns", sim_rounds * 64 * sim_words);
+  init_simulation();
+
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  bool res = 1;
+
+  for (unsigned round = 0; res && round < sim_rounds; round++) {
+    init_inputs(round, state);
+
+    uint64_t diff[sim_words];
+    simulate_round(diff);
+
+    for (unsigned w = 0; res && w < sim_words; w++) {
+      if (!diff[w]) continue;
+
+      unsigned p = 64*w;
+      while (!(diff[w] >> (p % 64) & 1)) p++;
+      msg("simulation found a mismatch in round %u", round);
+      report_mismatch(p, inp_f, write_cex);
+      res = 0;
+    }
+  }
+
+  if (res) msg("simulation found no mismatch");
+  reset_simulation();
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+std::vector<bool> validate_counter_examples(
+  const std::vector<std::vector<bool>> & cands) {
+  std::vector<bool> res(cands.size(), 0);
+  init_simulation();
+
+  for (size_t first = 0; first < cands.size(); first += 64 * sim_words) {
+    size_t num = std::min(cands.size() - first,
+                          static_cast<size_t>(64 * sim_words));
+    for (unsigned v = 1; v <= NN; v++)
+      for (unsigned w = 0; w < sim_words; w++) values[v * sim_words + w] = 0;
+
+    for (size_t p = 0; p < num; p++) {
+      uint64_t bit = static_cast<uint64_t>(1) << (p % 64);
+      const std::vector<bool> & cand = cands[first + p];
+      for (unsigned i = 0; i < NN; i++)
+        if (cand[i]) values[(i+1) * sim_words + p / 64] |= bit;
+    }
+
+    uint64_t diff[sim_words];
+    simulate_round(diff);
+    for (size_t p = 0; p < num; p++)
+      res[first + p] = (diff[p / 64] >> (p % 64)) & 1;
+  }
+
+  reset_simulation();
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+void find_counter_examples(
+  unsigned n, std::vector<std::vector<bool>> & cexs) {
+  std::set<std::vector<bool>> found(cexs.begin(), cexs.end());
+  init_simulation();
+
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  for (unsigned round = 0; cexs.size() < n && round < cex_rounds; round++) {
+    init_inputs(round, state);
+
+    uint64_t diff[sim_words];
+    simulate_round(diff);
+
+    for (unsigned p = 0; cexs.size() < n && p < 64 * sim_words; p++) {
+      if (!((diff[p / 64] >> (p % 64)) & 1)) continue;
+      std::vector<bool> cex = get_pattern(p);
+      if (found.insert(cex).second) cexs.push_back(cex);
+    }
+  }
+
+  reset_simulation();
+}
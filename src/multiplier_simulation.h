@@ -0,0 +1,65 @@
+/*------------------------------------------------------------------------*/
+/*! \file multiplier_simulation.h
+    \brief bit-parallel simulation of the multiplier before the reduction
+
+  The input AIG is simulated on 256 patterns at a time and the outputs are
+  compared against a reference product, which is computed bit-parallel by
+  a shift-and-add multiplier on the same words. The first patterns are
+  structured operands (zero, one, all ones, alternating and grouped bits as
+  they occur in booth recoding, minimal and maximal signed values, walking
+  ones and zeros), the remaining patterns are random.
+
+  A mismatch is written as counter example in the '.cex' format of
+  generate_witness and verification stops before slicing.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_MULTIPLIER_SIMULATION_H_
+#define AMULET2_SRC_MULTIPLIER_SIMULATION_H_
+/*------------------------------------------------------------------------*/
+#include <vector>
+
+#include "elimination.h"
+/*------------------------------------------------------------------------*/
+// / set to true to simulate the multiplier before the reduction
+extern thread_local bool multiplier_simulation;
+
+/**
+    Simulates the multiplier against the reference product. If a mismatch
+    is found it is printed and written to the counter example file, unless
+    the generation of counter examples is disabled.
+
+    @param inp_f name of the input file, used for the counter example file
+    @param write_cex bool, whether the counter example file is written
+
+    @return true if no mismatch was found
+*/
+bool simulate_multiplier(const char * inp_f, bool write_cex);
+
+/**
+    Simulates the given input vectors, which are ordered as the inputs of
+    the AIG, and checks whether they distinguish the multiplier from the
+    reference product.
+
+    @param cands const std::vector<std::vector<bool>> & candidate vectors
+
+    @return std::vector<bool>, true for candidates that are counter examples
+*/
+std::vector<bool> validate_counter_examples(
+  const std::vector<std::vector<bool>> & cands);
+
+/**
+    Searches for further counter examples using structured and random
+    patterns, until cexs contains n distinct counter examples or the
+    maximal number of rounds is reached.
+
+    @param n unsigned number of requested counter examples
+    @param cexs std::vector<std::vector<bool>> &, found counter examples
+                are appended
+*/
+void find_counter_examples(
+  unsigned n, std::vector<std::vector<bool>> & cexs);
+
+#endif  // AMULET2_SRC_MULTIPLIER_SIMULATION_H_
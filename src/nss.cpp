@@ -9,10 +9,12 @@
 #include <map>
 
 #include "nss.h"
+#include "trace.h"
 /*------------------------------------------------------------------------*/
-static Polynomial * mod_factor;
+static thread_local Polynomial * mod_factor;
 /*------------------------------------------------------------------------*/
 void print_spec_poly(FILE * file) {
+  TRACE_SCOPE("print_spec_poly");
   mpz_t coeff;
   mpz_init(coeff);
 
@@ -55,6 +57,7 @@ void print_spec_poly(FILE * file) {
 /*------------------------------------------------------------------------*/
 
 void print_cofactors_poly_nss(FILE * file) {
+  TRACE_SCOPE("print_cofactors_poly_nss");
   bool first = 1;
   fprintf(file, "%i %% ", M+1);
   for (unsigned i = num_gates-1; i >= NN ; i--) {
@@ -73,8 +76,9 @@ void print_cofactors_poly_nss(FILE * file) {
     fprintf(file, " + 1 *(");
     mod_factor->print(file, 0);
     fputs(")\n", file);
-    delete(mod_factor);
   }
+  delete(mod_factor);
+  mod_factor = 0;
 
   fputs(" , ", file);
   print_spec_poly(file);
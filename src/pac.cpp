@@ -7,14 +7,16 @@
 */
 /*------------------------------------------------------------------------*/
 #include "pac.h"
+#include "trace.h"
 /*------------------------------------------------------------------------*/
-static int poly_idx;
+static thread_local int poly_idx;
 /*------------------------------------------------------------------------*/
 // ERROR CODES:
 static int err_rule       = 81; // error in proof rule
 /*------------------------------------------------------------------------*/
 
 void print_circuit_poly(FILE * file) {
+  TRACE_SCOPE("print_circuit_poly");
   fputs("1 ", file);
   mpz_out_str(file, 10, mod_coeff);
   fputs(";\n", file);
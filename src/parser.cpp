@@ -7,6 +7,7 @@
 */
 /*------------------------------------------------------------------------*/
 #include "parser.h"
+#include "trace.h"
 /*------------------------------------------------------------------------*/
 // ERROR CODES:
 static int err_parsing       = 20; // general parsing error
@@ -98,6 +99,7 @@ void init_aiger_with_checks() {
 /*------------------------------------------------------------------------*/
 
 void parse_aig(const char * input_name) {
+  TRACE_SCOPE("parse");
   init_aig_parsing();
 
   msg("reading '%s'", input_name);
@@ -106,3 +108,29 @@ void parse_aig(const char * input_name) {
 
   init_aiger_with_checks();
 }
+
+/*------------------------------------------------------------------------*/
+
+void parse_aig_buffer(const char * buffer, size_t size) {
+  TRACE_SCOPE("parse");
+  init_aig_parsing();
+
+  msg("reading AIG from buffer of %zu bytes", size);
+  const char * err = aiger_read_buffer_to_model(buffer, size);
+  if (err) die(err_parsing, "error parsing buffer: %s", err);
+
+  init_aiger_with_checks();
+}
+
+/*------------------------------------------------------------------------*/
+
+void parse_aig_copy(const aiger * aig) {
+  TRACE_SCOPE("parse");
+  init_aig_parsing();
+
+  msg("copying AIG with %u ands", aig->num_ands);
+  const char * err = aiger_copy_to_model(aig);
+  if (err) die(err_parsing, "error copying AIG: %s", err);
+
+  init_aiger_with_checks();
+}
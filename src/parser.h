@@ -41,5 +41,21 @@ void init_aiger_with_checks();
 */
 void parse_aig(const char * input_name);
 
+/**
+    Reads the input aiger given in AIGER format in a memory buffer to the
+    aiger 'model'
+
+    @param buffer const char* contents of an AIGER file
+    @param size size_t number of bytes in buffer
+*/
+void parse_aig_buffer(const char * buffer, size_t size);
+
+/**
+    Copies the given aiger to the aiger 'model'
+
+    @param aig const aiger* input AIG, which is not modified
+*/
+void parse_aig_copy(const aiger * aig);
+
 
 #endif  // AMULET2_SRC_PARSER_H_
@@ -0,0 +1,230 @@
+/*------------------------------------------------------------------------*/
+/*! \file perf_counters.cpp
+    \brief hardware performance counters per phase and per slice
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include "perf_counters.h"
+#include "signal_statistics.h"
+
+#ifdef AMULETPERF
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include <vector>
+/*------------------------------------------------------------------------*/
+// / number of counters
+#define NUM_COUNTERS 4
+
+// / names of the counters, as printed in the header of the statistics
+static const char * counter_names[NUM_COUNTERS] = {
+  "cycles", "instructions", "LLC misses", "branch misses"
+};
+
+// / type and configuration of the counters passed to perf_event_open
+static const uint32_t counter_types[NUM_COUNTERS] = {
+  PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+  PERF_TYPE_HARDWARE
+};
+static const uint64_t counter_configs[NUM_COUNTERS] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_LL |
+    (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+  PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/** \struct Perf_record
+    Counts of one phase or slice
+*/
+struct Perf_record {
+  const char * phase;              // /< name of the phase
+  int slice;                       // /< reduced slice, -1 for phases
+  uint64_t count[NUM_COUNTERS];    // /< counts of the counters
+};
+
+// / file descriptors of the counters, -1 if a counter is not available
+static thread_local int fds[NUM_COUNTERS] = { -1, -1, -1, -1 };
+
+// / error of perf_event_open if no counter is available
+static thread_local int open_error = 0;
+
+// / counts at the end of the previous phase and of the previous record
+static thread_local uint64_t last_phase[NUM_COUNTERS];
+static thread_local uint64_t last_record[NUM_COUNTERS];
+
+// / phases in the order they first finished, followed by the slices
+static thread_local std::vector<Perf_record> phases, slice_records;
+
+// / true once init_perf_counters was called on this thread
+static thread_local bool initialized = 0;
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Reads all counters, scaled up if the kernel had to multiplex them
+
+    @param count uint64_t array of NUM_COUNTERS entries that is filled
+*/
+static void read_counters(uint64_t * count) {
+  for (int i = 0; i < NUM_COUNTERS; i++) {
+    uint64_t value[3];  // value, time enabled, time running
+    count[i] = 0;
+    if (fds[i] < 0) continue;
+    if (read(fds[i], value, sizeof value) != sizeof value) continue;
+    if (value[2] && value[2] < value[1])
+      value[0] = static_cast<uint64_t>(
+        static_cast<double>(value[0]) * value[1] / value[2]);
+    count[i] = value[0];
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Adds the counts since the previous record to r and starts a new record
+
+    @param r Perf_record & that is increased
+*/
+static void charge_record(Perf_record & r) {
+  uint64_t count[NUM_COUNTERS];
+  read_counters(count);
+  for (int i = 0; i < NUM_COUNTERS; i++) {
+    r.count[i] += count[i] - last_record[i];
+    last_record[i] = count[i];
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+void init_perf_counters() {
+  initialized = 1;
+  for (int i = 0; i < NUM_COUNTERS; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = counter_types[i];
+    attr.config = counter_configs[i];
+    attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.inherit = 1;  // include the threads started later on
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fds[i] < 0) open_error = errno;
+  }
+  read_counters(last_phase);
+  read_counters(last_record);
+}
+
+/*------------------------------------------------------------------------*/
+
+void perf_counters_phase(const char * phase) {
+  if (!initialized) return;
+
+  // a phase is repeated, e.g. 'parse' and 'reset' in batch mode, the
+  // counts are summed up per name
+  size_t j = 0;
+  while (j < phases.size() && strcmp(phases[j].phase, phase)) j++;
+  if (j == phases.size()) {
+    Perf_record r;
+    memset(&r, 0, sizeof r);
+    r.phase = phase;
+    r.slice = -1;
+    phases.push_back(r);
+  }
+
+  uint64_t count[NUM_COUNTERS];
+  read_counters(count);
+  for (int i = 0; i < NUM_COUNTERS; i++) {
+    phases[j].count[i] += count[i] - last_phase[i];
+    last_phase[i] = last_record[i] = count[i];
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+void perf_counters_slice(int i) {
+  if (!initialized) return;
+
+  Perf_record r;
+  memset(&r, 0, sizeof r);
+  r.phase = "slice";
+  r.slice = i;
+  charge_record(r);
+  slice_records.push_back(r);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Prints one line of counts
+
+    @param name const char * first column
+    @param r const Perf_record & counts
+*/
+static void print_record(const char * name, const Perf_record & r) {
+  char line[128];
+  int len = snprintf(line, sizeof line, "  %-20s", name);
+  for (int i = 0; i < NUM_COUNTERS; i++) {
+    if (fds[i] < 0)
+      len += snprintf(line + len, sizeof line - len, " %14s", "-");
+    else
+      len += snprintf(line + len, sizeof line - len, " %14llu",
+        static_cast<unsigned long long>(r.count[i]));
+  }
+  if (fds[0] >= 0 && fds[1] >= 0 && r.count[0])
+    snprintf(line + len, sizeof line - len, " %6.2f",
+      static_cast<double>(r.count[1]) / r.count[0]);
+  else
+    snprintf(line + len, sizeof line - len, " %6s", "-");
+  msg("%s", line);
+}
+
+/*------------------------------------------------------------------------*/
+
+void print_perf_counters() {
+  if (!initialized) return;
+
+  msg("");
+  bool available = 0;
+  for (int i = 0; i < NUM_COUNTERS; i++)
+    if (fds[i] >= 0) available = 1;
+  if (!available) {
+    msg("hardware performance counters not available: %s",
+      strerror(open_error));
+    return;
+  }
+
+  msg("hardware performance counters:");
+  msg("  %-20s %14s %14s %14s %14s %6s", "phase", counter_names[0],
+    counter_names[1], counter_names[2], counter_names[3], "IPC");
+  for (size_t j = 0; j < phases.size(); j++)
+    print_record(phases[j].phase, phases[j]);
+
+  char name[32];
+  for (size_t j = 0; j < slice_records.size(); j++) {
+    snprintf(name, sizeof name, "slice %i", slice_records[j].slice);
+    print_record(name, slice_records[j]);
+  }
+}
+
+/*------------------------------------------------------------------------*/
+#else
+
+void init_perf_counters() { }
+
+void perf_counters_phase(const char *) { }
+
+void perf_counters_slice(int) { }
+
+void print_perf_counters() { }
+
+#endif
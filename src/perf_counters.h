@@ -0,0 +1,48 @@
+/*------------------------------------------------------------------------*/
+/*! \file perf_counters.h
+    \brief hardware performance counters per phase and per slice
+
+  With './configure.sh -p' (defines AMULETPERF) the counters for cycles,
+  instructions, last level cache misses and branch misses are opened with
+  perf_event_open for the main thread and the threads it starts. They are
+  read whenever the profiler records a phase or a slice, and the counts
+  are printed by print_statistics. Counters that the kernel or the machine
+  does not provide, e.g. in virtual machines or with a restrictive
+  perf_event_paranoid setting, are reported as not available. Without
+  AMULETPERF all functions do nothing.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_PERF_COUNTERS_H_
+#define AMULET2_SRC_PERF_COUNTERS_H_
+/*------------------------------------------------------------------------*/
+
+/**
+    Opens and starts the counters for the calling thread
+*/
+void init_perf_counters();
+
+/**
+    Reads the counters and charges the counts since the previous phase to
+    the given phase
+
+    @param phase const char * name of the phase that just finished
+*/
+void perf_counters_phase(const char * phase);
+
+/**
+    Reads the counters and charges the counts since the previous phase or
+    slice to slice i
+
+    @param i integer slice that was just reduced
+*/
+void perf_counters_slice(int i);
+
+/**
+    Prints the counts of all phases and slices
+*/
+void print_perf_counters();
+
+#endif  // AMULET2_SRC_PERF_COUNTERS_H_
@@ -8,9 +8,14 @@
 /*------------------------------------------------------------------------*/
 #include "polynomial.h"
 /*------------------------------------------------------------------------*/
+// Global variable
+thread_local int64_t num_polynomials = 0;
+/*------------------------------------------------------------------------*/
 
-Polynomial::Polynomial() {}
-Polynomial::Polynomial (Monomial ** m, size_t len):mon(m), num_mon(len) {}
+Polynomial::Polynomial() { num_polynomials++; }
+Polynomial::Polynomial (Monomial ** m, size_t len):mon(m), num_mon(len) {
+  num_polynomials++;
+}
 
 /*------------------------------------------------------------------------*/
 
@@ -43,6 +48,7 @@ void Polynomial::print(FILE * file, bool end) const {
 /*------------------------------------------------------------------------*/
 
 Polynomial::~Polynomial() {
+  num_polynomials--;
   for (size_t i = 0 ; i < size(); i++) {
     Monomial * m = get_mon(i);
     deallocate_monomial(m);
@@ -84,10 +90,10 @@ int Polynomial::min_term_size() const {
 }
 
 /*------------------------------------------------------------------------*/
-// Local variables
-static size_t size_mstack;  // /< size of mstack
-static size_t num_mstack = 0;  // /< number of elements in mstack
-static Monomial ** mstack;  // /< Monomial** used for building poly
+// Local variables, every thread builds its polynomials on its own mstack
+static thread_local size_t size_mstack;  // /< size of mstack
+static thread_local size_t num_mstack = 0;  // /< number of elements in mstack
+static thread_local Monomial ** mstack;  // /< Monomial** used for building poly
 /*------------------------------------------------------------------------*/
 
 void enlarge_mstack() {
@@ -357,10 +363,10 @@ Polynomial * divide_by_term(const Polynomial * p1, const Term * t) {
 
 
 /*------------------------------------------------------------------------*/
-mpz_t one;
-mpz_t minus_one;
-mpz_t base;
-mpz_t mod_coeff;
+thread_local mpz_t one;
+thread_local mpz_t minus_one;
+thread_local mpz_t base;
+thread_local mpz_t mod_coeff;
 
 /*------------------------------------------------------------------------*/
 
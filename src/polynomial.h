@@ -15,6 +15,9 @@
 
 #include "monomial.h"
 /*------------------------------------------------------------------------*/
+// / number of polynomials allocated minus deallocated by the calling thread
+extern thread_local int64_t num_polynomials;
+/*------------------------------------------------------------------------*/
 
 /** \class Polynomial
     This class is used to polynomials.
@@ -207,16 +210,16 @@ Polynomial * divide_by_term(const Polynomial * p1, const Term * t);
 
 /*---------------------------------------------------------------------------*/
 // / gmp for 1
-extern mpz_t one;
+extern thread_local mpz_t one;
 
 // / gmp for -1
-extern mpz_t minus_one;
+extern thread_local mpz_t minus_one;
 
 // / gmp for 2
-extern mpz_t base;
+extern thread_local mpz_t base;
 
 // / gmp for 2^NN
-extern mpz_t mod_coeff;
+extern thread_local mpz_t mod_coeff;
 /*---------------------------------------------------------------------------*/
 /**
     Initializes all global gmp objects
@@ -7,39 +7,41 @@
 */
 /*------------------------------------------------------------------------*/
 #include "polynomial_solver.h"
+#include "trace.h"
 /*------------------------------------------------------------------------*/
 // Global variable
-bool gen_witness = 1;
+thread_local bool gen_witness = 1;
 /*------------------------------------------------------------------------*/
 // ERROR CODES:
 static int err_writing = 41; // cannot write to
 static int err_rem_poly =42; // remainder poly no witness
 /*------------------------------------------------------------------------*/
 void init_gates_verify() {
+  TRACE_SCOPE("init_gates_verify");
   init_mpz(NN);
   allocate_gates();
   mark_aig_outputs();
   set_parents_and_children(1);
   set_xor();
+  // gate constraints are generated on first access, unless
+  // multiple threads are used to generate them upfront
+  if (num_threads > 1) init_gate_constraints();
 }
 
 /*------------------------------------------------------------------------*/
-// Print all gate constraints to `file` (if `file` is 0 prints to stdout)
-static void print_all_gate_constraints(FILE * file) {
+/**
+    Prints all gate constraints to stdout, used at verbosity level 4. The
+    dump never goes to the proof files, since it would invalidate them.
+*/
+static void print_all_gate_constraints() {
   for (unsigned i = NN; i < M-1; ++i) {
     Gate * g = gates[i];
     if (!g) continue;
     Polynomial * p = g->get_gate_constraint();
     if (!p) continue;
-    if (file) {
-      fprintf(file, "[amulet2] gate %s:\n", g->get_var_name());
-      p->print(file);
-      fprintf(file, "\n");
-    } else {
-      fprintf(stdout, "[amulet2] gate %s:\n", g->get_var_name());
-      p->print(stdout);
-      fprintf(stdout, "\n");
-    }
+    fprintf(stdout, "[amulet2] gate %s:\n", g->get_var_name());
+    p->print(stdout);
+    fprintf(stdout, "\n");
   }
 
   // outputs
@@ -48,28 +50,54 @@ static void print_all_gate_constraints(FILE * file) {
     if (!g) continue;
     Polynomial * p = g->get_gate_constraint();
     if (!p) continue;
-    if (file) {
-      fprintf(file, "[amulet2] output %s:\n", g->get_var_name());
-      p->print(file);
-      fprintf(file, "\n");
-    } else {
-      fprintf(stdout, "[amulet2] output %s:\n", g->get_var_name());
-      p->print(stdout);
-      fprintf(stdout, "\n");
-    }
+    fprintf(stdout, "[amulet2] output %s:\n", g->get_var_name());
+    p->print(stdout);
+    fprintf(stdout, "\n");
   }
 }
 
+/*------------------------------------------------------------------------*/
+/** \class File_closer
+    Closes a file that is still open when it goes out of scope, i.e., when
+    an error is thrown before the file is closed regularly
+*/
+class File_closer {
+  // / file that is closed, 0 once it has been closed regularly
+  FILE *& file;
+
+ public:
+  /** Constructor
+
+      @param f FILE *& that is closed unless it is 0
+  */
+  explicit File_closer(FILE *& f): file(f) {}
+
+  File_closer(const File_closer &) = delete;
+
+  /** Destructor */
+  ~File_closer() { if (file) fclose(file); }
+};
+
 /*------------------------------------------------------------------------*/
 
 bool verify(const char * inp_f, const char * out_f1,
             const char * out_f2, const char * out_f3, bool certify) {
-  assert(!certify || inp_f);
   assert(!certify || out_f1);
   assert(!certify || out_f2);
   assert(!certify || out_f3);
 
+  if (multiplier_simulation) {
+    bool passed = simulate_multiplier(inp_f, inp_f && gen_witness);
+    profile_phase("simulation");
+    if (!passed) {
+      msg("INCORRECT MULTIPLIER");
+      init_time = slicing_elim_time = reduction_time = process_time();
+      return 0;
+    }
+  }
+
   FILE * f1 = 0, *f2 = 0, *f3 = 0;
+  File_closer close_f1(f1), close_f2(f2), close_f3(f3);
   if (certify) {
     if (!(f1 = fopen(out_f1, "w")))
     die(err_writing, "can not write output to '%s'", out_f1);
@@ -90,9 +118,10 @@ bool verify(const char * inp_f, const char * out_f1,
 
   mark_xor_chain_in_last_slice();
   init_time = process_time();
+  profile_phase("init");
 
-  //print gate constraints before elimination
-  print_all_gate_constraints(f2);
+  // print gate constraints before elimination, this generates all of them
+  if (verbose >= 4) print_all_gate_constraints();
 
 
   remove_internal_xor_gates(f2);
@@ -120,15 +149,18 @@ bool verify(const char * inp_f, const char * out_f1,
 
 
   slicing_elim_time = process_time();
+  profile_phase("slicing/elimination");
 
   const Polynomial * rem = reduce(f2);
   bool res;
   if (rem && !rem->is_constant_zero_poly())  {
     if (!check_inputs_only(rem)){
-      msg("REMAINDER IS");
-      fputs("[amulet2] ", stdout);
-      rem->print(stdout);
-      msg("");
+      if (!quiet) {
+        msg("REMAINDER IS");
+        fputs("[amulet2] ", stdout);
+        rem->print(stdout);
+        msg("");
+      }
       die(err_rem_poly, "slicing failure - remainder polynomial contains non-inputs");
 
     }
@@ -137,11 +169,13 @@ bool verify(const char * inp_f, const char * out_f1,
     msg("INCORRECT MULTIPLIER");
     msg("");
 
-    if (inp_f && gen_witness) {
-      msg("REMAINDER IS");
-      fputs("[amulet2] ", stdout);
-      rem->print(stdout);
-      msg("");
+    if (gen_witness) {
+      if (!quiet) {
+        msg("REMAINDER IS");
+        fputs("[amulet2] ", stdout);
+        rem->print(stdout);
+        msg("");
+      }
       generate_witness(rem, inp_f);
     }
   } else {
@@ -160,10 +194,13 @@ bool verify(const char * inp_f, const char * out_f1,
   if (proof == 3) print_cofactors_poly_nss(f2);
 
   reduction_time = process_time();
+  profile_phase("result");
   if (certify) {
+    TRACE_SCOPE("close_proof_files");
     fclose(f1);
     fclose(f2);
     fclose(f3);
+    f1 = f2 = f3 = 0;
   }
   return res;
 }
@@ -10,11 +10,12 @@
 #define AMULET2_SRC_POLYNOMIAL_SOLVER_H_
 /*------------------------------------------------------------------------*/
 #include "elimination.h"
+#include "multiplier_simulation.h"
 /*------------------------------------------------------------------------*/
 // / If final remainder is not equal to zero a counter example is generated and
 // / printed to file <input_name>.wit, default is true, can be turned of
 //  using command line input
-extern bool gen_witness;
+extern thread_local bool gen_witness;
 /*------------------------------------------------------------------------*/
 
 /**
@@ -28,7 +29,8 @@ void init_gates_verify();
     Calls the preprocessing, slicing, reduction routines
     If certify is true, files need to be provided to store the proof.
 
-    @param inp_f name of input file
+    @param inp_f name of input file, used for the counter example file,
+                 if 0 no counter example file is written
     @param out_f1 name of first output file
     @param out_f2 name of second output file
     @param out_f3 name of third output file
@@ -0,0 +1,158 @@
+/*------------------------------------------------------------------------*/
+/*! \file profiler.cpp
+    \brief records time and memory per phase and per slice
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <vector>
+
+#include "perf_counters.h"
+#include "profiler.h"
+/*------------------------------------------------------------------------*/
+// Global variable
+const char * profile_name = 0;
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_writing = 101; // cannot write to
+/*------------------------------------------------------------------------*/
+
+/** \struct Profile_record
+    One record of the profiler, times are measured since the previous record
+*/
+struct Profile_record {
+  const char * phase;      // /< name of the phase
+  int slice;               // /< reduced slice, -1 for phases
+  double wall;             // /< elapsed wall clock time
+  double cpu;              // /< elapsed process time
+  uint64_t terms;          // /< number of terms in the term table
+  uint64_t table;          // /< number of buckets of the term table
+  int64_t monomials;       // /< number of live monomials
+  int64_t polynomials;     // /< number of live polynomials
+  size_t rem_size;         // /< number of monomials in the remainder
+  unsigned rem_degree;     // /< maximal term size in the remainder
+  size_t max_rss;          // /< maximum resident set size
+};
+
+static thread_local std::vector<Profile_record> records;
+
+static thread_local double last_wall, last_cpu;
+
+/*------------------------------------------------------------------------*/
+
+void init_profiler() {
+  if (!profile_name) return;
+  records.clear();
+  last_wall = wall_clock_time();
+  last_cpu = process_time();
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Adds a record for the given phase and slice
+
+    @param phase char * name of the phase
+    @param i integer slice, -1 for phases
+    @param rem const Polynomial*, may be 0
+*/
+static void add_record(const char * phase, int i, const Polynomial * rem) {
+  double wall = wall_clock_time(), cpu = process_time();
+
+  Profile_record r;
+  r.phase = phase;
+  r.slice = i;
+  r.wall = wall - last_wall;
+  r.cpu = cpu - last_cpu;
+  r.terms = num_terms();
+  r.table = term_table_size();
+  r.monomials = num_monomials;
+  r.polynomials = num_polynomials;
+  r.rem_size = rem ? rem->size() : 0;
+  r.rem_degree = 0;
+  for (size_t j = 0; rem && j < rem->size(); j++) {
+    Term * t = rem->get_mon(j)->get_term();
+    unsigned d = t ? t->size() : 0;
+    if (d > r.rem_degree) r.rem_degree = d;
+  }
+  r.max_rss = maximum_resident_set_size();
+  records.push_back(r);
+
+  last_wall = wall;
+  last_cpu = cpu;
+}
+
+/*------------------------------------------------------------------------*/
+
+void profile_phase(const char * phase) {
+  perf_counters_phase(phase);
+  if (!profile_name) return;
+  add_record(phase, -1, 0);
+}
+
+/*------------------------------------------------------------------------*/
+
+void profile_slice(int i, const Polynomial * rem) {
+  perf_counters_slice(i);
+  if (!profile_name) return;
+  add_record("slice", i, rem);
+}
+
+/*------------------------------------------------------------------------*/
+
+void profile_abort(int i, const Polynomial * rem) {
+  if (!profile_name) return;
+  add_record("abort", i, rem);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Checks whether the file name ends in ".csv"
+
+    @param name char *
+
+    @return true if CSV output is selected
+*/
+static bool is_csv_name(const char * name) {
+  size_t len = strlen(name);
+  return len >= 4 && !strcmp(name + len - 4, ".csv");
+}
+
+/*------------------------------------------------------------------------*/
+
+void write_profile() {
+  if (!profile_name) return;
+
+  FILE * file;
+  if (!(file = fopen(profile_name, "w")))
+    die(err_writing, "can not write profile to '%s'", profile_name);
+
+  bool csv = is_csv_name(profile_name);
+  if (csv) {
+    fputs("phase,slice,wall,cpu,terms,term_table,monomials,polynomials,"
+      "rem_size,rem_degree,max_rss\n", file);
+  } else {
+    fputs("[\n", file);
+  }
+
+  for (size_t i = 0; i < records.size(); i++) {
+    const Profile_record & r = records[i];
+    const char * fmt = csv ?
+      "%s,%i,%.6f,%.6f,%lu,%lu,%li,%li,%lu,%u,%lu\n" :
+      "  {\"phase\": \"%s\", \"slice\": %i, \"wall\": %.6f, \"cpu\": %.6f, "
+      "\"terms\": %lu, \"term_table\": %lu, \"monomials\": %li, "
+      "\"polynomials\": %li, \"rem_size\": %lu, \"rem_degree\": %u, "
+      "\"max_rss\": %lu}";
+    fprintf(file, fmt, r.phase, r.slice, r.wall, r.cpu,
+      (unsigned long) r.terms, (unsigned long) r.table,
+      (long) r.monomials, (long) r.polynomials,
+      (unsigned long) r.rem_size, r.rem_degree, (unsigned long) r.max_rss);
+    if (!csv) fputs(i+1 < records.size() ? ",\n" : "\n", file);
+  }
+
+  if (!csv) fputs("]\n", file);
+  fclose(file);
+  msg("written profile to '%s'", profile_name);
+}
@@ -0,0 +1,61 @@
+/*------------------------------------------------------------------------*/
+/*! \file profiler.h
+    \brief records time and memory per phase and per slice
+
+  The profiler records after each phase of AMulet2 and after each slice
+  in the reduction the elapsed wall and process time, the number of live
+  terms, monomials and polynomials, the size of the term table and the size
+  and degree of the current remainder. The records are written as JSON or,
+  if the file name ends in '.csv', as CSV. Phases and slices are also
+  passed to the hardware performance counters, see perf_counters.h.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_PROFILER_H_
+#define AMULET2_SRC_PROFILER_H_
+/*------------------------------------------------------------------------*/
+#include "polynomial.h"
+#include "signal_statistics.h"
+/*------------------------------------------------------------------------*/
+// / Name of the profile file, profiling is disabled if 0
+extern const char * profile_name;
+
+/**
+    Drops the records of the calling thread and starts the clocks of the
+    profiler, does nothing if profile_name is 0. The records are kept per
+    thread and written by write_profile on the same thread.
+*/
+void init_profiler();
+
+/**
+    Records the phase that just finished, does nothing if profile_name is 0
+
+    @param phase char * name of the phase
+*/
+void profile_phase(const char * phase);
+
+/**
+    Records the reduction of slice i, does nothing if profile_name is 0
+
+    @param i integer slice
+    @param rem const Polynomial* remainder after reducing slice i
+*/
+void profile_slice(int i, const Polynomial * rem);
+
+/**
+    Records the partial reduction of slice i before an abort, does nothing
+    if profile_name is 0
+
+    @param i integer slice
+    @param rem const Polynomial* current remainder, may be 0
+*/
+void profile_abort(int i, const Polynomial * rem);
+
+/**
+    Writes all records to profile_name, does nothing if profile_name is 0
+*/
+void write_profile();
+
+#endif  // AMULET2_SRC_PROFILER_H_
@@ -0,0 +1,89 @@
+/*------------------------------------------------------------------------*/
+/*! \file progress.cpp
+    \brief progress reports of the reduction
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include "progress.h"
+#include "slicing.h"
+#include "spill.h"
+/*------------------------------------------------------------------------*/
+// Global variables
+thread_local double progress_interval = 0;
+
+/*------------------------------------------------------------------------*/
+// Local variables
+
+// / number of gate constraints of the reduced slices, and reduced so far
+static thread_local uint64_t total_gates, done_gates;
+
+// / slice that is currently reduced
+static thread_local int current_slice;
+
+// / number of gate constraints and wall clock time at the start of the
+// / current slice
+static thread_local uint64_t slice_start_gates;
+static thread_local double slice_start_time;
+
+// / wall clock time at the start of the reduction, of the last report and
+// / when the next report is due
+static thread_local double start_time, last_report, next_report;
+
+// / remainder monomials processed since the last report
+static thread_local uint64_t processed;
+
+/*------------------------------------------------------------------------*/
+
+void init_progress(int first) {
+  total_gates = done_gates = slice_start_gates = processed = 0;
+  for (int i = first; i >= 0; i--) {
+    const Slice & sl = slices[i];
+    for (Slice::const_iterator it = sl.begin(); it != sl.end(); ++it)
+      if (!(*it)->get_elim()) total_gates++;
+  }
+  current_slice = first;
+  start_time = slice_start_time = last_report = wall_clock_time();
+  next_report = start_time + progress_interval;
+}
+
+/*------------------------------------------------------------------------*/
+
+void report_progress(int slice, const Polynomial * rem) {
+  size_t size = rem ? rem->size() : spilled_size();
+  done_gates++;
+  processed += size;
+
+  if (slice != current_slice) {
+    current_slice = slice;
+    slice_start_gates = done_gates - 1;
+    slice_start_time = wall_clock_time();
+  }
+
+  if (!progress_requested && progress_interval <= 0) return;
+  double now = wall_clock_time();
+  if (!progress_requested && now < next_report) return;
+  progress_requested = 0;
+
+  // extrapolate from the completed slices and from the current slice,
+  // the current slice dominates if the remainder blows up
+  uint64_t left = total_gates > done_gates ? total_gates - done_gates : 0;
+  double eta = (now - slice_start_time) / (done_gates - slice_start_gates);
+  if (slice_start_gates) {
+    double done = (slice_start_time - start_time) / slice_start_gates;
+    if (done > eta) eta = done;
+  }
+  eta *= left;
+  double rate = now > last_report ? processed / (now - last_report) : 0;
+
+  msg("progress: slice %i, %llu of %llu gates left, remainder %zu "
+    "monomials, %.3g monomials/s, %.2f MB, ETA %.0f seconds",
+    slice, static_cast<unsigned long long>(left),
+    static_cast<unsigned long long>(total_gates), size, rate,
+    maximum_resident_set_size() / static_cast<double>(1<<20), eta);
+
+  processed = 0;
+  last_report = now;
+  next_report = now + progress_interval;
+}
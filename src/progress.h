@@ -0,0 +1,45 @@
+/*------------------------------------------------------------------------*/
+/*! \file progress.h
+    \brief progress reports of the reduction
+
+  A progress report contains the current slice, the number of gate
+  constraints that are left, the size of the remainder, the number of
+  remainder monomials processed per second since the previous report, the
+  maximum resident set size and an estimate of the remaining time. The
+  estimate extrapolates the average time per gate constraint to the
+  remaining gate constraints, using the larger average of the completed
+  slices and of the current slice.
+
+  Reports are printed every progress_interval seconds and whenever the
+  process receives SIGUSR1.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_PROGRESS_H_
+#define AMULET2_SRC_PROGRESS_H_
+/*------------------------------------------------------------------------*/
+#include "polynomial.h"
+/*------------------------------------------------------------------------*/
+// / Seconds between two progress reports, only on SIGUSR1 if 0
+extern thread_local double progress_interval;
+
+/**
+    Counts the gate constraints of the slices first to 0 and starts the
+    clock of the progress reports
+
+    @param first integer, first slice that is reduced
+*/
+void init_progress(int first);
+
+/**
+    Counts one reduction step and prints a progress report if it is due or
+    has been requested by SIGUSR1
+
+    @param slice integer, slice that is currently reduced
+    @param rem const Polynomial*, current remainder, 0 if it is spilled
+*/
+void report_progress(int slice, const Polynomial * rem);
+
+#endif  // AMULET2_SRC_PROGRESS_H_
@@ -0,0 +1,74 @@
+/*------------------------------------------------------------------------*/
+/*! \file resource_limits.cpp
+    \brief memory and time limits of the reduction
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include "gate.h"
+#include "profiler.h"
+#include "resource_limits.h"
+#include "spill.h"
+#include "trace.h"
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_memory_limit = 191;  // memory limit exceeded
+static int err_time_limit   = 192;  // time limit exceeded
+/*------------------------------------------------------------------------*/
+// Global variables
+thread_local double max_memory = 0;
+thread_local double max_time = 0;
+
+// / thread time at the start of the reduction
+static thread_local double start_time = 0;
+
+/*------------------------------------------------------------------------*/
+
+void init_resource_limits() {
+  start_time = thread_time();
+}
+
+/*------------------------------------------------------------------------*/
+
+void check_resource_limits(int slice, const Polynomial * rem) {
+  if (max_memory <= 0 && max_time <= 0) return;
+
+  double mb = resident_set_size() / static_cast<double>(1<<20);
+  double time = thread_time() - start_time;
+  bool out_of_memory = max_memory > 0 && mb > max_memory;
+  bool out_of_time = max_time > 0 && time > max_time;
+  if (!out_of_memory && !out_of_time) return;
+
+  msg("");
+  if (out_of_memory) msg("memory limit of %g MB exceeded", max_memory);
+  else
+    msg("time limit of %g seconds exceeded", max_time);
+
+  unsigned degree = 0;
+  for (size_t i = 0; rem && i < rem->size(); i++) {
+    const Term * t = rem->get_mon(i)->get_term();
+    unsigned d = t ? t->size() : 0;
+    if (d > degree) degree = d;
+  }
+  msg("aborted while reducing slice %i, %i of %u slices are reduced",
+    slice, static_cast<int>(NN) - 1 - slice, NN);
+  if (rem)
+    msg("remainder has %zu monomials of degree at most %u",
+      rem->size(), degree);
+  else if (spilled_size())
+    msg("spilled remainder has %llu monomials",
+      static_cast<unsigned long long>(spilled_size()));
+  msg("resident set size:             %22.2f MB", mb);
+  msg("process time of the reduction: %22.2f seconds", time);
+
+  profile_abort(slice, rem);
+  write_profile();
+  write_trace();
+
+  if (out_of_memory)
+    die(err_memory_limit, "memory limit of %g MB exceeded in slice %i",
+      max_memory, slice);
+  die(err_time_limit, "time limit of %g seconds exceeded in slice %i",
+    max_time, slice);
+}
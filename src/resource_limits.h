@@ -0,0 +1,46 @@
+/*------------------------------------------------------------------------*/
+/*! \file resource_limits.h
+    \brief memory and time limits of the reduction
+
+  The reduction checks after every gate constraint whether the resident
+  set size or the process time used since the start of the reduction
+  exceeds the given limit. In that case the run is aborted with a message
+  on the reached slice and the size of the current remainder, an 'abort'
+  record is added to the profile and the profile is written, before die is
+  called with err_memory_limit or err_time_limit.
+
+  The time is measured for the reducing thread only, thus contexts that
+  run on separate threads do not count against each other. The current
+  resident set size is measured for the whole process, since memory is not
+  attributed to threads, and is shared by all contexts of the process.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_RESOURCE_LIMITS_H_
+#define AMULET2_SRC_RESOURCE_LIMITS_H_
+/*------------------------------------------------------------------------*/
+#include "polynomial.h"
+/*------------------------------------------------------------------------*/
+// / Memory limit in MB, no limit if 0
+extern thread_local double max_memory;
+
+// / Limit of the process time of the reduction in seconds, no limit if 0
+extern thread_local double max_time;
+
+/**
+    Starts the clock of the time limit, called at the start of the reduction
+*/
+void init_resource_limits();
+
+/**
+    Aborts the reduction if the memory or the time limit is exceeded
+
+    @param slice integer, slice that is currently reduced
+    @param rem const Polynomial*, current remainder, 0 if it is spilled to
+               disk or not yet computed
+*/
+void check_resource_limits(int slice, const Polynomial * rem);
+
+#endif  // AMULET2_SRC_RESOURCE_LIMITS_H_
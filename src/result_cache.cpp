@@ -0,0 +1,272 @@
+/*------------------------------------------------------------------------*/
+/*! \file result_cache.cpp
+    \brief on-disk cache of verification results, keyed by a structural
+    fingerprint of the AIG
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "result_cache.h"
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_writing = 151;  // cannot write counter example file
+/*------------------------------------------------------------------------*/
+// Global variables
+thread_local const char * cache_dir = 0;
+
+// / name of the entry of the design of the last lookup
+static thread_local std::string entry_name;
+/*------------------------------------------------------------------------*/
+// Hash values, the two halves of the fingerprint use different seeds
+typedef std::pair<uint64_t, uint64_t> Fingerprint;
+
+static uint64_t mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ull;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebull;
+  x ^= x >> 31;
+  return x;
+}
+
+static Fingerprint mix(const Fingerprint & f, uint64_t tag) {
+  return Fingerprint(mix(f.first + tag),
+                     mix(f.second + (tag ^ 0x9e3779b97f4a7c15ull)));
+}
+
+static Fingerprint leaf(uint64_t tag) {
+  return mix(Fingerprint(0x243f6a8885a308d3ull, 0x13198a2e03707344ull), tag);
+}
+
+/*------------------------------------------------------------------------*/
+// Combines the fingerprints of the operands of an AND gate, independent
+// of their order
+static Fingerprint combine(Fingerprint a, Fingerprint b) {
+  if (b < a) std::swap(a, b);
+  Fingerprint res = mix(a, 0xa4093822299f31d0ull);
+  return mix(Fingerprint(res.first ^ b.first, res.second ^ b.second),
+             0x082efa98ec4e6c89ull);
+}
+
+/*------------------------------------------------------------------------*/
+
+std::string structural_fingerprint() {
+  unsigned maxvar = get_model_maxvar();
+  std::vector<Fingerprint> fp(maxvar + 1);
+  std::vector<bool> done(maxvar + 1, 0);
+
+  fp[0] = leaf(0), done[0] = 1;
+  // inputs are tagged by operand and bit position
+  for (unsigned k = 0; k < NN/2; k++) {
+    unsigned va = aiger_lit2var(get_model_inputs_lit(a0 + k*ainc));
+    unsigned vb = aiger_lit2var(get_model_inputs_lit(b0 + k*binc));
+    fp[va] = leaf((1ull << 32) | k), done[va] = 1;
+    fp[vb] = leaf((2ull << 32) | k), done[vb] = 1;
+  }
+
+  auto lit_fp = [&fp](unsigned lit) {
+    const Fingerprint & f = fp[aiger_lit2var(lit)];
+    return aiger_sign(lit) ? mix(f, 0x452821e638d01377ull) : f;
+  };
+
+  std::vector<unsigned> stack;
+  for (unsigned i = 0; i < NN; i++) {
+    stack.push_back(aiger_lit2var(slit(i)));
+    while (!stack.empty()) {
+      unsigned v = stack.back();
+      if (done[v]) { stack.pop_back(); continue; }
+      aiger_and * and1 = is_model_and(aiger_var2lit(v));
+      assert(and1);
+      unsigned v0 = aiger_lit2var(and1->rhs0);
+      unsigned v1 = aiger_lit2var(and1->rhs1);
+      if (!done[v0]) { stack.push_back(v0); continue; }
+      if (!done[v1]) { stack.push_back(v1); continue; }
+      fp[v] = combine(lit_fp(and1->rhs0), lit_fp(and1->rhs1));
+      done[v] = 1;
+      stack.pop_back();
+    }
+  }
+
+  Fingerprint res = leaf(NN);
+  for (unsigned i = 0; i < NN; i++) {
+    Fingerprint o = lit_fp(slit(i));
+    res = mix(Fingerprint(res.first ^ o.first, res.second ^ o.second), i);
+  }
+
+  char buf[33];
+  snprintf(buf, sizeof buf, "%016llx%016llx",
+    static_cast<unsigned long long>(res.first),
+    static_cast<unsigned long long>(res.second));
+  return buf;
+}
+
+/*------------------------------------------------------------------------*/
+// Returns a digest of the contents of the file, empty if it can not be read
+static std::string file_digest(const char * name) {
+  FILE * file = fopen(name, "r");
+  if (!file) return "";
+  uint64_t h = 0xcbf29ce484222325ull;
+  char buf[1 << 16];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof buf, file)) > 0)
+    for (size_t i = 0; i < n; i++)
+      h = (h ^ static_cast<unsigned char>(buf[i])) * 0x100000001b3ull;
+  fclose(file);
+  char res[17];
+  snprintf(res, sizeof res, "%016llx", static_cast<unsigned long long>(h));
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+// Translates a counter example from the order of the AIG inputs to the
+// operand order a[0], ..., a[n-1], b[0], ..., b[n-1] and back
+static std::string cex_to_operand_order(const std::vector<bool> & cex) {
+  std::string res;
+  for (unsigned k = 0; k < NN/2; k++) res += cex[a0 + k*ainc] ? '1' : '0';
+  for (unsigned k = 0; k < NN/2; k++) res += cex[b0 + k*binc] ? '1' : '0';
+  return res;
+}
+
+static std::vector<bool> cex_from_operand_order(const std::string & bits) {
+  std::vector<bool> res(NN, 0);
+  for (unsigned k = 0; k < NN/2; k++) {
+    res[a0 + k*ainc] = bits[k] == '1';
+    res[b0 + k*binc] = bits[NN/2 + k] == '1';
+  }
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+// Reports the cached counter examples as generate_witness
+static void report_cached_witnesses(
+  const std::vector<std::string> & cexs, const char * inp_f) {
+  std::string witness_name;
+  FILE * witness_file = 0;
+  if (inp_f) {
+    witness_name = witness_file_name(inp_f);
+    if (!(witness_file = fopen(witness_name.c_str(), "w")))
+      die(err_writing, "cannot write output to '%s'", witness_name.c_str());
+  }
+
+  msg("");
+  msg("COUNTER EXAMPLES ARE: ");
+  for (const std::string & bits : cexs)
+    write_witness_vector(cex_from_operand_order(bits), witness_file);
+
+  if (!witness_file) return;
+  fprintf(witness_file, ".");
+  fclose(witness_file);
+  print_witness_note(inp_f, witness_name.c_str());
+}
+
+/*------------------------------------------------------------------------*/
+
+bool lookup_cached_result(const char * inp_f, const char * out_f1,
+  const char * out_f2, const char * out_f3, bool certify, bool & res) {
+  std::string key = structural_fingerprint();
+  key += certify ? "-certify-p" + std::to_string(proof) : "-verify";
+  key += signed_mult ? "-signed" : "-unsigned";
+  if (!gen_witness) key += "-nocex";
+  else if (max_counter_examples)
+    key += "-cex" + std::to_string(max_counter_examples);
+  entry_name = std::string(cache_dir) + "/" + key;
+
+  FILE * file = fopen(entry_name.c_str(), "r");
+  if (!file) {
+    msg("result cache miss for fingerprint %s", key.substr(0, 32).c_str());
+    return 0;
+  }
+
+  bool correct = 0, valid = 0;
+  double time = 0;
+  std::vector<std::string> digests, cexs;
+  char buf[1 << 16];
+  while (fgets(buf, sizeof buf, file)) {
+    std::istringstream line(buf);
+    std::string tag, value;
+    line >> tag >> value;
+    if (tag == "verdict") {
+      valid = value == "correct" || value == "incorrect";
+      correct = value == "correct";
+    } else if (tag == "time") {
+      time = atof(value.c_str());
+    } else if (tag == "digest") {
+      digests.push_back(value);
+    } else if (tag == "cex" && value.size() == NN) {
+      cexs.push_back(value);
+    }
+  }
+  fclose(file);
+
+  if (valid && certify) {
+    valid = correct && digests.size() == 3 &&
+      file_digest(out_f1) == digests[0] &&
+      file_digest(out_f2) == digests[1] &&
+      file_digest(out_f3) == digests[2];
+  }
+  if (!valid) {
+    msg("result cache entry %s is not reusable", key.c_str());
+    return 0;
+  }
+
+  msg("result cache hit for fingerprint %s (originally %.2f seconds)",
+    key.substr(0, 32).c_str(), time);
+  res = correct;
+  if (correct) {
+    msg("");
+    msg("CORRECT MULTIPLIER");
+  } else {
+    msg("INCORRECT MULTIPLIER");
+    msg("");
+    if (gen_witness) report_cached_witnesses(cexs, inp_f);
+  }
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+void store_cached_result(const char * out_f1, const char * out_f2,
+  const char * out_f3, bool certify, bool res, double time) {
+  if (certify && !res) return;
+
+  // entries are written to a temporary file and renamed, such that
+  // concurrent readers never see a partial entry
+  std::ostringstream tmp;
+  tmp << entry_name << ".tmp." << getpid() << "."
+      << std::hash<std::thread::id>()(std::this_thread::get_id());
+  FILE * file = fopen(tmp.str().c_str(), "w");
+  if (!file && !mkdir(cache_dir, 0777)) file = fopen(tmp.str().c_str(), "w");
+  if (!file) {
+    msg("can not write result cache entry '%s'", entry_name.c_str());
+    return;
+  }
+  fprintf(file, "verdict %s\n", res ? "correct" : "incorrect");
+  fprintf(file, "mode %s\n", certify ? "certify" : "verify");
+  if (certify) fprintf(file, "proof %d\n", proof);
+  fprintf(file, "signed %d\n", signed_mult);
+  fprintf(file, "time %.3f\n", time);
+  if (certify) {
+    fprintf(file, "digest %s\n", file_digest(out_f1).c_str());
+    fprintf(file, "digest %s\n", file_digest(out_f2).c_str());
+    fprintf(file, "digest %s\n", file_digest(out_f3).c_str());
+  }
+  for (const std::vector<bool> & cex : counter_examples)
+    fprintf(file, "cex %s\n", cex_to_operand_order(cex).c_str());
+  bool ok = !fclose(file);
+  if (!ok || rename(tmp.str().c_str(), entry_name.c_str())) {
+    unlink(tmp.str().c_str());
+    msg("can not write result cache entry '%s'", entry_name.c_str());
+  }
+}
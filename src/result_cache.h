@@ -0,0 +1,72 @@
+/*------------------------------------------------------------------------*/
+/*! \file result_cache.h
+    \brief on-disk cache of verification results, keyed by a structural
+    fingerprint of the AIG
+
+  The fingerprint is a 128 bit hash of the AND graph, in which inputs are
+  identified by their role as bit of operand a or b and outputs by their
+  position. It does not depend on symbol names, on the numbering and order
+  of the AND gates, on the order of their operands, or on whether the
+  operands are interleaved. A cache entry is a text file in the cache
+  directory, named by the fingerprint, the mode and the options that
+  influence the result. It stores the verdict, the time of the original
+  run, the counter examples in operand order and, for '-certify', digests
+  of the proof files.
+
+  A certified result is only reused if the output files still have the
+  recorded digests, otherwise the design is certified again.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_RESULT_CACHE_H_
+#define AMULET2_SRC_RESULT_CACHE_H_
+/*------------------------------------------------------------------------*/
+#include <string>
+
+#include "polynomial_solver.h"
+/*------------------------------------------------------------------------*/
+// / Directory of the result cache, the cache is disabled if 0
+extern thread_local const char * cache_dir;
+
+/**
+    Computes the structural fingerprint of the parsed AIG, requires that
+    the input order has been determined
+
+    @return std::string of 32 hexadecimal digits
+*/
+std::string structural_fingerprint();
+
+/**
+    Looks up the result of the parsed design. On a hit the verdict and the
+    counter examples are reported as by verify, the counter example file
+    is written if inp_f is given.
+
+    @param inp_f name of the input file, may be 0
+    @param out_f1 name of the gate constraints file in certify
+    @param out_f2 name of the proof file in certify
+    @param out_f3 name of the specification file in certify
+    @param certify bool
+    @param res bool &, set to the cached verdict on a hit
+
+    @return true on a hit
+*/
+bool lookup_cached_result(const char * inp_f, const char * out_f1,
+  const char * out_f2, const char * out_f3, bool certify, bool & res);
+
+/**
+    Stores the result of the design of the last lookup together with the
+    counter examples collected in counter_examples
+
+    @param out_f1 name of the gate constraints file in certify
+    @param out_f2 name of the proof file in certify
+    @param out_f3 name of the specification file in certify
+    @param certify bool
+    @param res bool verdict
+    @param time double seconds used for the verification
+*/
+void store_cached_result(const char * out_f1, const char * out_f2,
+  const char * out_f3, bool certify, bool res, double time);
+
+#endif  // AMULET2_SRC_RESULT_CACHE_H_
@@ -0,0 +1,287 @@
+/*------------------------------------------------------------------------*/
+/*! \file server.cpp
+    \brief verification daemon serving requests over a Unix domain socket
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "server.h"
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_socket  = 141;  // cannot create, bind or listen on socket
+static int err_request = 142;  // malformed request, only sent to the client
+static int err_internal = 143; // request aborted, only sent to the client
+/*------------------------------------------------------------------------*/
+// / maximal size of the AIG of one request in bytes
+static const size_t max_payload = static_cast<size_t>(1) << 30;
+
+// / seconds a connection may be idle before it is closed
+static const int read_timeout = 300;
+/*------------------------------------------------------------------------*/
+
+/** \struct Server_state
+    State shared by the accepting thread and the workers
+*/
+struct Server_state {
+  int listen_fd = -1;                // /< listening socket
+  std::mutex mutex;                  // /< protects connections and stopping
+  std::condition_variable ready;     // /< signals new connections and stop
+  std::deque<int> connections;       // /< accepted, not yet served sockets
+  bool stopping = 0;                 // /< set by a 'shutdown' request
+  std::atomic<size_t> requests{0};   // /< number of answered requests
+};
+
+/*------------------------------------------------------------------------*/
+// Stops accepting connections, which wakes up the accepting thread
+static void stop_server(Server_state * state) {
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->stopping = 1;
+  }
+  state->ready.notify_all();
+  shutdown(state->listen_fd, SHUT_RDWR);
+}
+
+/*------------------------------------------------------------------------*/
+// Writes the answer of a request
+static void write_response(FILE * out, const Amulet_result & res) {
+  fprintf(out, "%s %.3f\n", amulet_status_name(res.status), res.wall_time);
+  for (const std::vector<bool> & cex : res.counter_examples) {
+    fputs("cex ", out);
+    for (bool b : cex) fputc(b ? '1' : '0', out);
+    fputc('\n', out);
+  }
+  if (res.status == amulet_failed)
+    fprintf(out, "error %d %s\n", res.error_code, res.error_message.c_str());
+  fputs("end\n", out);
+  fflush(out);
+}
+
+/*------------------------------------------------------------------------*/
+// Answers a malformed request, the connection is closed afterwards
+static void reject_request(FILE * out, const std::string & line) {
+  Amulet_result res;
+  res.error_code = err_request;
+  res.error_message = "malformed request '" + line + "'";
+  write_response(out, res);
+  msg("serve rejected malformed request '%s'", line.c_str());
+}
+
+/*------------------------------------------------------------------------*/
+// Serves the requests of one connection, returns when the client closes
+// the connection or sends 'shutdown'
+static void serve_connection(Server_state * state,
+  Verification_context & context, const Verification_options & options,
+  int fd) {
+  FILE * in = fdopen(fd, "r");
+  FILE * out = fdopen(dup(fd), "w");
+  if (!in || !out) {
+    if (in) fclose(in);
+    else
+      close(fd);
+    if (out) fclose(out);
+    return;
+  }
+
+  std::vector<char> payload;
+  char buf[4096];
+  while (fgets(buf, sizeof buf, in)) {
+    std::string line = buf;
+    if (line.empty() || line.back() != '\n') {
+      // header longer than the buffer or cut off by the client
+      reject_request(out, line.substr(0, 64) + "...");
+      break;
+    }
+    while (!line.empty() && isspace(line.back())) line.pop_back();
+
+    std::istringstream header(line);
+    std::vector<std::string> words;
+    std::string word;
+    while (header >> word) words.push_back(word);
+    if (words.empty()) continue;
+
+    if (words[0] == "shutdown") {
+      msg("serve received shutdown");
+      stop_server(state);
+      fputs("end\n", out);
+      fflush(out);
+      break;
+    }
+
+    bool certify = words[0] == "certify";
+    size_t first_flag = certify ? 5 : 2;
+    if ((!certify && words[0] != "verify") || words.size() < first_flag) {
+      reject_request(out, line);
+      break;
+    }
+
+    char * end;
+    size_t size = strtoull(words[1].c_str(), &end, 10);
+    bool valid = !*end && size && size <= max_payload;
+
+    Verification_options request_options = options;
+    if (certify) request_options.proof = 2;
+    for (size_t i = first_flag; valid && i < words.size(); i++) {
+      if (words[i] == "-signed") request_options.signed_mult = 1;
+      else if (words[i] == "-simulate") request_options.simulate = 1;
+      else if (words[i] == "-no-counter-examples")
+        request_options.gen_witness = 0;
+      else if (certify && words[i] == "-p1") request_options.proof = 1;
+      else if (certify && words[i] == "-p2") request_options.proof = 2;
+      else if (certify && words[i] == "-p3") request_options.proof = 3;
+      else
+        valid = 0;
+    }
+    if (!valid) {
+      reject_request(out, line);
+      break;
+    }
+
+    Amulet_result res;
+    try {
+      payload.resize(size);
+      if (fread(payload.data(), 1, size, in) != size) break;
+
+      context.options = request_options;
+      res = amulet_parse(context, payload.data(), size);
+      if (res.status != amulet_failed) {
+        double parse_time = res.wall_time;
+        if (certify) {
+          res = amulet_certify(context,
+            words[2].c_str(), words[3].c_str(), words[4].c_str());
+        } else {
+          res = amulet_verify(context);
+        }
+        res.wall_time += parse_time;
+      }
+    } catch (const std::exception & e) {
+      // e.g. std::bad_alloc, the design is freed to recover the memory
+      context.reset();
+      res = Amulet_result();
+      res.error_code = err_internal;
+      res.error_message = std::string("request aborted: ") + e.what();
+    }
+    write_response(out, res);
+    state->requests++;
+
+    msg("serve %-9s %10.2f seconds  %s %zu bytes",
+      amulet_status_name(res.status), res.wall_time, words[0].c_str(), size);
+  }
+
+  fclose(in);
+  fclose(out);
+}
+
+/*------------------------------------------------------------------------*/
+// Worker thread, serves connections until the server is stopped and no
+// connection is left
+static void serve_worker(
+  Server_state * state, const Verification_options * options) {
+  Verification_context context(*options);
+  for (;;) {
+    int fd;
+    {
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->ready.wait(lock, [state]() {
+        return state->stopping || !state->connections.empty();
+      });
+      if (state->connections.empty()) break;
+      fd = state->connections.front();
+      state->connections.pop_front();
+    }
+    serve_connection(state, context, *options, fd);
+  }
+  deallocate_mstack();
+}
+
+/*------------------------------------------------------------------------*/
+
+void serve(const char * socket_name, const Verification_options & options,
+           unsigned workers) {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof addr);
+  addr.sun_family = AF_UNIX;
+  if (strlen(socket_name) >= sizeof addr.sun_path)
+    die(err_socket, "socket name '%s' is too long", socket_name);
+  strcpy(addr.sun_path, socket_name);
+
+  struct stat st;
+  if (!stat(socket_name, &st) && S_ISSOCK(st.st_mode)) unlink(socket_name);
+
+  Server_state state;
+  state.listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (state.listen_fd < 0) die(err_socket, "can not create socket");
+
+  // certify requests write files with the permissions of the server, so
+  // only its owner may connect
+  mode_t old_mask = umask(0177);
+  int bound = bind(state.listen_fd,
+    reinterpret_cast<struct sockaddr*>(&addr), sizeof addr);
+  umask(old_mask);
+  if (bound) die(err_socket, "can not bind socket '%s'", socket_name);
+  if (chmod(socket_name, S_IRUSR | S_IWUSR))
+    die(err_socket, "can not restrict permissions of socket '%s'",
+      socket_name);
+  if (listen(state.listen_fd, 64))
+    die(err_socket, "can not listen on socket '%s'", socket_name);
+
+  // clients closing their connection early must not kill the server
+  signal(SIGPIPE, SIG_IGN);
+
+  Verification_options quiet_options = options;
+  quiet_options.verbose = 0;
+  quiet_options.quiet = 1;
+
+  msg("serving on '%s' with %u workers", socket_name, workers);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < workers; t++)
+    threads.push_back(std::thread(serve_worker, &state, &quiet_options));
+
+  for (;;) {
+    int fd = accept(state.listen_fd, 0, 0);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      break;
+    }
+    struct timeval timeout;
+    timeout.tv_sec = read_timeout;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof timeout);
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      state.connections.push_back(fd);
+    }
+    state.ready.notify_one();
+  }
+
+  stop_server(&state);
+  for (unsigned t = 0; t < workers; t++) threads[t].join();
+  for (int fd : state.connections) close(fd);
+  close(state.listen_fd);
+  unlink(socket_name);
+
+  msg("served %zu requests", state.requests.load());
+}
@@ -0,0 +1,58 @@
+/*------------------------------------------------------------------------*/
+/*! \file server.h
+    \brief verification daemon serving requests over a Unix domain socket
+
+  The server accepts connections on a Unix domain socket and hands them to
+  a pool of worker threads. Every worker keeps one verification context,
+  and thus its term table and monomial stack, for its whole lifetime, so
+  that only the first request of a worker pays for their allocation.
+
+  A connection carries any number of requests, each consisting of one
+  header line, optionally followed by an AIG in AIGER format (ASCII or
+  binary) of the given number of bytes:
+
+    verify <bytes> [<flag> ...]
+    certify <bytes> <out.polys> <out.proof> <out.spec> [<flag> ...]
+    shutdown
+
+  where <flag> is one of '-signed', '-simulate', '-no-counter-examples',
+  and for certify '-p1', '-p2', '-p3'. The proof files are written by the
+  server, hence the socket is only accessible by the user running it.
+  Payloads are limited to 1 GB, header lines to 4095 characters, and a
+  connection is closed after 300 seconds without data. A malformed header
+  is answered with error 142 and closes the connection. A request aborted
+  by an exception, e.g. running out of memory, is answered with error 143
+  and the connection is served further. Every request is answered by the
+  lines
+
+    <status> <seconds>
+    cex <bits>            (once per counter example, inputs in AIG order)
+    error <code> <message> (only for status 'failed')
+    end
+
+  where <status> is 'correct', 'incorrect' or 'failed'. The request
+  'shutdown' stops accepting connections, lets the workers finish their
+  connections and is answered by 'end'.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_SERVER_H_
+#define AMULET2_SRC_SERVER_H_
+/*------------------------------------------------------------------------*/
+#include "libamulet.h"
+/*------------------------------------------------------------------------*/
+
+/**
+    Serves verification requests on the Unix domain socket until a
+    'shutdown' request is received. A stale socket file is replaced.
+
+    @param socket_name char * path of the socket
+    @param options const Verification_options & default options of requests
+    @param workers unsigned number of worker threads
+*/
+void serve(const char * socket_name, const Verification_options & options,
+           unsigned workers);
+
+#endif  // AMULET2_SRC_SERVER_H_
@@ -6,7 +6,9 @@
   Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
 */
 /*------------------------------------------------------------------------*/
+#include <unistd.h>
 
+#include "perf_counters.h"
 #include "signal_statistics.h"
 
 /*------------------------------------------------------------------------*/
@@ -15,6 +17,8 @@ void(*original_SIGINT_handler)(int);
 void(*original_SIGSEGV_handler)(int);
 void(*original_SIGABRT_handler)(int);
 void(*original_SIGTERM_handler)(int);
+void(*original_SIGUSR1_handler)(int);
+volatile sig_atomic_t progress_requested = 0;
 /*------------------------------------------------------------------------*/
 
 const char * signal_name(int sig) {
@@ -23,6 +27,7 @@ const char * signal_name(int sig) {
     case SIGSEGV: return "SIGSEGV";
     case SIGABRT: return "SIGABRT";
     case SIGTERM: return "SIGTERM";
+    case SIGUSR1: return "SIGUSR1";
     default: return "SIGUNKNOWN";
   }
 }
@@ -34,6 +39,7 @@ void init_all_signal_handers() {
   original_SIGSEGV_handler = signal(SIGSEGV, catch_signal);
   original_SIGABRT_handler = signal(SIGABRT, catch_signal);
   original_SIGTERM_handler = signal(SIGTERM, catch_signal);
+  original_SIGUSR1_handler = signal(SIGUSR1, catch_progress_signal);
 }
 
 /*------------------------------------------------------------------------*/
@@ -48,25 +54,37 @@ void catch_signal(int sig) {
 
 /*------------------------------------------------------------------------*/
 
+void catch_progress_signal(int) {
+  progress_requested = 1;
+}
+
+/*------------------------------------------------------------------------*/
+
 void reset_all_signal_handlers() {
   (void) signal(SIGINT, original_SIGINT_handler);
   (void) signal(SIGSEGV, original_SIGSEGV_handler);
   (void) signal(SIGABRT, original_SIGABRT_handler);
   (void) signal(SIGTERM, original_SIGTERM_handler);
+  (void) signal(SIGUSR1, original_SIGUSR1_handler);
 }
 
 /*------------------------------------------------------------------------*/
 // Global variable
-int verbose = 1;
+thread_local int verbose = 1;
+thread_local bool throw_errors = 0;
+thread_local bool quiet = 0;
 /*------------------------------------------------------------------------*/
 
 void msg(const char *fmt, ...) {
+  if (quiet) return;
   va_list ap;
+  flockfile(stdout);
   fputs_unlocked("[amulet2] ", stdout);
   va_start(ap, fmt);
   vfprintf(stdout, fmt, ap);
   va_end(ap);
   fputc_unlocked('\n', stdout);
+  funlockfile(stdout);
   fflush(stdout);
 }
 
@@ -74,22 +92,27 @@ void msg(const char *fmt, ...) {
 
 void die(int error_code, const char *fmt, ...) {
   fflush(stdout);
+  char buf[1024];
   va_list ap;
-  fprintf(stderr, "*** [amulet2] error code %i \n", error_code);
-  fputs_unlocked("*** [amulet2] ", stderr);
   va_start(ap, fmt);
-  vfprintf(stderr, fmt, ap);
+  vsnprintf(buf, sizeof buf, fmt, ap);
   va_end(ap);
+  flockfile(stderr);
+  fprintf(stderr, "*** [amulet2] error code %i \n", error_code);
+  fputs_unlocked("*** [amulet2] ", stderr);
+  fputs_unlocked(buf, stderr);
   fputc('\n', stderr);
+  funlockfile(stderr);
   fflush(stderr);
+  if (throw_errors) throw Amulet_error(error_code, buf);
   exit(error_code);
 }
 
 /*------------------------------------------------------------------------*/
 // Global variables
 
-double init_time, slicing_elim_time, reduction_time, reset_time;
-double substitution_time;
+thread_local double init_time, slicing_elim_time, reduction_time, reset_time;
+thread_local double substitution_time;
 
 /*------------------------------------------------------------------------*/
 
@@ -111,18 +134,50 @@ double process_time() {
 
 /*------------------------------------------------------------------------*/
 
+size_t resident_set_size() {
+  FILE * file = fopen("/proc/self/statm", "r");
+  if (!file) return maximum_resident_set_size();
+  unsigned long size, resident;
+  int read = fscanf(file, "%lu %lu", &size, &resident);
+  fclose(file);
+  if (read != 2) return maximum_resident_set_size();
+  return static_cast<size_t>(resident) * sysconf(_SC_PAGESIZE);
+}
+
+/*------------------------------------------------------------------------*/
+
+double thread_time() {
+  struct rusage u;
+  if (getrusage(RUSAGE_THREAD, &u)) return 0;
+  double res = u.ru_utime.tv_sec + 1e-6 * u.ru_utime.tv_usec;
+  res += u.ru_stime.tv_sec + 1e-6 * u.ru_stime.tv_usec;
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+double wall_clock_time() {
+  struct timeval tv;
+  if (gettimeofday(&tv, 0)) return 0;
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+/*------------------------------------------------------------------------*/
+
 void print_statistics(int modus) {
   msg("");
   msg("maximum resident set size:     %22.2f MB",
     maximum_resident_set_size() / static_cast<double>((1<<20)));
-  msg("used time for initializing:    %22.2f seconds",
-      init_time);
   if (modus == 1) {
+    msg("used time for initializing:    %22.2f seconds",
+      init_time);
     msg("used time for substituion:     %22.2f seconds",
       substitution_time - init_time);
     msg("used time for freeing memory:  %22.2f seconds",
       reset_time - substitution_time);
-  } else {
+  } else if (modus < 4) {
+    msg("used time for initializing:    %22.2f seconds",
+      init_time);
     msg("used time for slicing/elimination: %18.2f seconds",
       slicing_elim_time - init_time);
     msg("used time for reduction:           %18.2f seconds",
@@ -131,4 +186,5 @@ void print_statistics(int modus) {
       reset_time  -reduction_time);
   }
   msg("total process time:            %22.2f seconds",  process_time());
+  print_perf_counters();
 }
@@ -15,11 +15,17 @@
 #include <sys/resource.h>
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
 /*------------------------------------------------------------------------*/
 extern void(*original_SIGINT_handler)(int);
 extern void(*original_SIGSEGV_handler)(int);
 extern void(*original_SIGABRT_handler)(int);
 extern void(*original_SIGTERM_handler)(int);
+extern void(*original_SIGUSR1_handler)(int);
+
+// / set by SIGUSR1, requests a progress report from the reduction
+extern volatile sig_atomic_t progress_requested;
 
 /**
     Returns name of signal
@@ -43,6 +49,13 @@ void init_all_signal_handers();
 */
 void catch_signal(int sig);
 
+/**
+    Catches SIGUSR1 and requests a progress report
+
+    @param sig integer
+*/
+void catch_progress_signal(int sig);
+
 /**
     Resets all signal handlers
 */
@@ -50,10 +63,44 @@ void reset_all_signal_handlers();
 
 /*------------------------------------------------------------------------*/
 // / Level of output verbosity, ranges from 0 to 4
-extern int verbose;
+extern thread_local int verbose;
+
+// / If true, msg prints nothing, used for designs verified concurrently
+extern thread_local bool quiet;
+
+// / \brief
+// / If true, die throws an Amulet_error instead of exiting the program.
+// / Set while a verification context is active on the calling thread.
+extern thread_local bool throw_errors;
+
+/** \class Amulet_error
+    Error raised by die if throw_errors is set
+*/
+class Amulet_error : public std::runtime_error {
+  // / error code passed to die
+  int error_code;
+
+ public:
+  /**
+      Constructor
+
+      @param _error_code integer
+      @param what std::string error message
+  */
+  Amulet_error(int _error_code, const std::string & what) :
+    std::runtime_error(what), error_code(_error_code) { }
+
+  /**
+      Getter for member error_code
+
+      @return integer
+  */
+  int get_error_code() const { return error_code; }
+};
 
 /**
-    Prints an error message to stderr and exits the program
+    Prints an error message to stderr and exits the program, or throws an
+    Amulet_error if throw_errors is set
 
     @param char* fmt message
     @param int error_code
@@ -69,11 +116,11 @@ void msg(const char *fmt, ...);
 /*------------------------------------------------------------------------*/
 
 // / Time measures used for verify/certify modus
-extern double init_time;          // /< measure initializing time
-extern double slicing_elim_time;  // /< measure time used to eliminate & slice
-extern double reduction_time;     // /< measure time used to reduce
-extern double reset_time;         // /< measure resetting time
-extern double substitution_time;  // /< measure time used in substitution
+extern thread_local double init_time;          // /< measure initializing time
+extern thread_local double slicing_elim_time;  // /< measure time used to eliminate & slice
+extern thread_local double reduction_time;     // /< measure time used to reduce
+extern thread_local double reset_time;         // /< measure resetting time
+extern thread_local double substitution_time;  // /< measure time used in substitution
 
 /**
     Determines max used memory
@@ -85,6 +132,24 @@ size_t maximum_resident_set_size();
 */
 double process_time();
 
+/**
+    Determines the current resident set size of the process, which in
+    contrast to maximum_resident_set_size decreases when memory is freed
+
+    @return size_t bytes, the maximum resident set size if unknown
+*/
+size_t resident_set_size();
+
+/**
+    Determines the process time used by the calling thread
+*/
+double thread_time();
+
+/**
+    Determines the elapsed wall clock time
+*/
+double wall_clock_time();
+
 /**
     Print statistics of maximum memory and used process time depending on
     selected modus
@@ -10,21 +10,69 @@
 #include <utility>
 
 #include "slicing.h"
+#include "trace.h"
 /*------------------------------------------------------------------------*/
 // ERROR CODES:
 static int err_top_child  = 31; // error in topological_largest_child
 /*------------------------------------------------------------------------*/
 // Global var
-std::vector<std::list<Gate*>> slices;
+thread_local std::vector<Slice> slices;
+/*------------------------------------------------------------------------*/
+// / distance between two labels after relabeling a slice
+static const uint64_t label_gap = (uint64_t) 1 << 32;
+
+void Slice::relabel() {
+  uint64_t label = 0;
+  for (std::list<Gate*>::iterator it = gate_list.begin();
+      it != gate_list.end(); ++it) {
+    label += label_gap;
+    (*it)->pos_label = label;
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+void Slice::insert(const_iterator pos, Gate * n) {
+  if (pos != end() && *pos == n) return;
+  if (n->pos_slice >= 0) slices[n->pos_slice].remove(n);
+
+  std::list<Gate*>::iterator it = gate_list.insert(pos, n);
+  n->pos_slice = idx;
+  n->pos = it;
+
+  std::list<Gate*>::iterator next = it;
+  ++next;
+  uint64_t lower = it == gate_list.begin() ? 0 : (*std::prev(it))->pos_label;
+  if (next == gate_list.end()) {
+    if (lower <= UINT64_MAX - label_gap) n->pos_label = lower + label_gap;
+    else
+      relabel();
+  } else if ((*next)->pos_label - lower > 1) {
+    n->pos_label = lower + ((*next)->pos_label - lower) / 2;
+  } else {
+    relabel();
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+void Slice::remove(Gate * n) {
+  if (!contains(n)) return;
+  gate_list.erase(n->pos);
+  n->pos_slice = -1;
+}
+
 /*------------------------------------------------------------------------*/
 
 void init_slices() {
+  TRACE_SCOPE("init_slices");
+  slices.clear();
+  slices.reserve(NN);
   for (unsigned i = 0; i < NN; i++) {
-    std::list<Gate*> l;
     Gate * n = gates[i+M-1];
     assert(n->get_output());
-    l.push_back(n);
-    slices.push_back(l);
+    slices.emplace_back(i);
+    slices[i].push_back(n);
     if (verbose >= 4) msg("init slice %i with output %s", i, n->get_var_name());
   }
 }
@@ -32,15 +80,11 @@ void init_slices() {
 
 void clean_slices(){
   for (int i=NN-1; i>= 0; i--) {
-  std::list<Gate*> sl = slices[i];
-
-  while(sl.size() > 1){
-    Gate * n = sl.back();
-    n->set_slice(-1);
-    sl.pop_back();
-  }
-
-  slices[i] = sl;
+    while(slices[i].size() > 1){
+      Gate * n = slices[i].back();
+      n->set_slice(-1);
+      slices[i].pop_back();
+    }
   }
 }
 
@@ -76,6 +120,7 @@ bool is_valid_available_xor(Gate * g, int i){
 
 
 void slice_by_xor_chains() {
+  TRACE_SCOPE("slice_by_xor_chains");
   for (unsigned i = 0; i < NN; i++) {
     Gate * output = gates[i+M-1];
     output->set_slice(i);
@@ -117,34 +162,49 @@ void slice_by_xor_chains() {
 }
 
 /*------------------------------------------------------------------------*/
+
+/** \struct Children_frame
+    Frame of the explicit depth-first traversal in
+    move_inserted_children_from_larger_slices
+*/
+struct Children_frame {
+  Gate * n;                                    // /< current gate
+  std::list<Gate*>::const_iterator child;      // /< next child of n
+};
+
+// / work stack of move_inserted_children_from_larger_slices
+static thread_local std::vector<Children_frame> children_stack;
+
 static void move_inserted_children_from_larger_slices
-  (Gate *n, std::list<Gate*>::const_iterator it){
-    int i = n->get_slice();
-    auto insert_pos = it;
-    for(auto iit = n->children_begin(); iit != n->children_end(); ++iit){
-      Gate * n_child = *iit;
-      if (n_child->get_input()) continue;
+  (Gate *n, std::list<Gate*>::const_iterator insert_pos){
+  children_stack.clear();
+  children_stack.push_back({n, n->children_begin()});
+  while (!children_stack.empty()) {
+    Children_frame & f = children_stack.back();
+    if (f.child == f.n->children_end()) {
+      children_stack.pop_back();
+      continue;
+    }
+    n = f.n;
+    Gate * n_child = *f.child++;
+    if (n_child->get_input()) continue;
 
-      if(n_child->get_slice() == i){
-        for (auto it = slices[i].begin(); it != slices[i].end(); ++it) {
-          Gate * n_it = *it;
-          if(n_it == n) break;
-          if(n_it == n_child){
-            slices[i].remove(n_child);
-            slices[n->get_slice()].insert(insert_pos, n_child);
-              if (verbose >= 4) msg("internally moved %s", n_child->get_var_name());
-            move_inserted_children_from_larger_slices(n_child, insert_pos);
-            break;
-          }
-        }
-      } else if(n_child->get_slice() > i) {
-        slices[n->get_slice()].insert(insert_pos, n_child);
-        slices[n_child->get_slice()].remove(n_child);
-        n_child->set_slice(n->get_slice());
-          if (verbose >= 4) msg("moved %s", n_child->get_var_name());
-        move_inserted_children_from_larger_slices(n_child, insert_pos);
+    int i = n->get_slice();
+    if(n_child->get_slice() == i){
+      // move n_child behind n if it is placed before n
+      if (slices[i].contains(n_child) &&
+          (!slices[i].contains(n) || slices[i].precedes(n_child, n))) {
+        slices[i].insert(insert_pos, n_child);
+          if (verbose >= 4) msg("internally moved %s", n_child->get_var_name());
+        children_stack.push_back({n_child, n_child->children_begin()});
       }
+    } else if(n_child->get_slice() > i) {
+      slices[n->get_slice()].insert(insert_pos, n_child);
+      n_child->set_slice(n->get_slice());
+        if (verbose >= 4) msg("moved %s", n_child->get_var_name());
+      children_stack.push_back({n_child, n_child->children_begin()});
     }
+  }
 }
 
 
@@ -160,7 +220,7 @@ static bool children_are_assigned_in_larger_slices(Gate * n, int i){
 void print_slices(){
 
   for (int i=NN-1; i>= 0; i--) {
-  std::list<Gate*> sl = slices[i];
+  const Slice & sl = slices[i];
   msg("slice %i", i);
   for (auto it=sl.begin(); it != sl.end(); ++it) {
     Gate * n_it = *it;
@@ -170,101 +230,152 @@ void print_slices(){
   }
 }
 
-static bool upwards_slicing(const Gate * n, const Gate * pre) {
-  if (n->get_slice() == -1 && pre->get_aig_output()) return 0;
+/*------------------------------------------------------------------------*/
 
+bool slices_are_consistent() {
+  for (int i = 0; i < static_cast<int>(slices.size()); i++) {
+    const Slice & sl = slices[i];
+    const Gate * prev = 0;
+    for (auto it = sl.begin(); it != sl.end(); ++it) {
+      const Gate * n = *it;
+      if (n->get_slice() != i || !sl.contains(n)) return 0;
+      if (prev && !sl.precedes(prev, n)) return 0;
+      prev = n;
+    }
+  }
+  return 1;
+}
 
-  for (auto it = n->parents_begin();
-       it != n->parents_end(); ++it) {
-    Gate * n_parent = *it;
+/*------------------------------------------------------------------------*/
 
-    if (n_parent->get_elim()) continue;
-    if (n_parent->get_slice() != -1) continue;
-    if (n_parent->get_output()) continue;
+/**
+    Assigns the parent n_parent of the gate pre to the slice of pre and
+    inserts it into the slice
 
+    @param n_parent Gate*
+    @param pre const Gate*
 
-    if (!parents_are_in_equal_or_larger_slice(n_parent, pre->get_slice()))
-      continue;
+    @return -1 if slicing fails, 1 if upwards slicing has to be continued
+            from n_parent, 0 otherwise
+*/
+static int upwards_slice_parent(Gate * n_parent, const Gate * pre) {
+  if (n_parent->get_elim()) return 0;
+  if (n_parent->get_slice() != -1) return 0;
+  if (n_parent->get_output()) return 0;
 
-    if( children_are_assigned_in_larger_slices(n_parent, 0)){
-      if (pre->get_slice() == 0) continue;
-      if(n_parent->get_carry_gate() -1 > pre->get_slice()) continue;
-    }
 
-    n_parent->set_slice(pre->get_slice());
+  if (!parents_are_in_equal_or_larger_slice(n_parent, pre->get_slice()))
+    return 0;
 
+  if( children_are_assigned_in_larger_slices(n_parent, 0)){
+    if (pre->get_slice() == 0) return 0;
+    if(n_parent->get_carry_gate() -1 > pre->get_slice()) return 0;
+  }
 
+  n_parent->set_slice(pre->get_slice());
 
-    if (!pre->is_child(n_parent)) {
-      int par_in_slice = 0;
-      std::list<Gate*> parents_in_slice;
-      for (auto it = slices[pre->get_slice()].begin();
-            it != slices[pre->get_slice()].end(); ++it) {
-        Gate * cmp = *it;
-        if (n_parent->is_in_parents(cmp)) {
-          parents_in_slice.push_back(cmp);
-        }
-      }
-      par_in_slice = parents_in_slice.size();
 
-      for ( auto it = slices[pre->get_slice()].begin();
-            it != slices[pre->get_slice()].end(); ++it) {
-        Gate * cmp = *it;
 
-        if(n_parent->is_child(cmp) && par_in_slice){
-          if(par_in_slice > 1) return 1;
+  if (!pre->is_child(n_parent)) {
+    int par_in_slice = 0;
+    std::list<Gate*> parents_in_slice;
+    for (auto it = slices[pre->get_slice()].begin();
+          it != slices[pre->get_slice()].end(); ++it) {
+      Gate * cmp = *it;
+      if (n_parent->is_in_parents(cmp)) {
+        parents_in_slice.push_back(cmp);
+      }
+    }
+    par_in_slice = parents_in_slice.size();
 
-          slices[pre->get_slice()].insert(it, n_parent);
+    for ( auto it = slices[pre->get_slice()].begin();
+          it != slices[pre->get_slice()].end(); ++it) {
+      Gate * cmp = *it;
 
+      if(n_parent->is_child(cmp) && par_in_slice){
+        if(par_in_slice > 1) return -1;
 
-          for(auto iit =parents_in_slice.begin(); iit != parents_in_slice.end(); ++iit){
-            Gate * tmp = *iit;
-            auto insert_pos = it;
-            slices[pre->get_slice()].insert(--insert_pos, tmp);
-            par_in_slice--;
-          }
-        } else if (((cmp == pre || n_parent->is_child(cmp)) && !par_in_slice)) {
+        slices[pre->get_slice()].insert(it, n_parent);
 
-          slices[n_parent->get_slice()].insert(it, n_parent);
 
-          move_inserted_children_from_larger_slices(n_parent, it);
-          break;
-        } else if (n_parent->is_in_parents(cmp) && par_in_slice > 1) {
+        for(auto iit =parents_in_slice.begin(); iit != parents_in_slice.end(); ++iit){
+          Gate * tmp = *iit;
+          auto insert_pos = it;
+          slices[pre->get_slice()].insert(--insert_pos, tmp);
           par_in_slice--;
-          parents_in_slice.remove(cmp);
-        } else if (n_parent->is_in_parents(cmp) && par_in_slice == 1 ) {
-          msg("insert %s after %s", n_parent->get_var_name(), cmp->get_var_name());
-          slices[n_parent->get_slice()].insert(++it, n_parent);
-          move_inserted_children_from_larger_slices(n_parent, it);
-          break;
-        }
-      }
-    } else {
-      //does this ever happen?!
-      for ( auto it = slices[pre->get_slice()].begin();
-        it != slices[pre->get_slice()].end(); ++it) {
-        Gate * cmp = *it;
-        if (cmp == pre) {
-          slices[pre->get_slice()].insert(++it, n_parent);
-          break;
         }
+      } else if (((cmp == pre || n_parent->is_child(cmp)) && !par_in_slice)) {
+
+        slices[n_parent->get_slice()].insert(it, n_parent);
+
+        move_inserted_children_from_larger_slices(n_parent, it);
+        break;
+      } else if (n_parent->is_in_parents(cmp) && par_in_slice > 1) {
+        par_in_slice--;
+        parents_in_slice.remove(cmp);
+      } else if (n_parent->is_in_parents(cmp) && par_in_slice == 1 ) {
+        msg("insert %s after %s", n_parent->get_var_name(), cmp->get_var_name());
+        slices[n_parent->get_slice()].insert(++it, n_parent);
+        move_inserted_children_from_larger_slices(n_parent, it);
+        break;
       }
     }
-
-    if (!n_parent->get_carry_gate()) {
-      if(upwards_slicing(n_parent, n_parent)) return 1;
-    } else if (!n_parent->all_parents_are_sliced()) {
-      if(upwards_slicing(n_parent, n_parent)) return 1;
+  } else {
+    //does this ever happen?!
+    for ( auto it = slices[pre->get_slice()].begin();
+      it != slices[pre->get_slice()].end(); ++it) {
+      Gate * cmp = *it;
+      if (cmp == pre) {
+        slices[pre->get_slice()].insert(++it, n_parent);
+        break;
+      }
     }
   }
 
+  if (!n_parent->get_carry_gate()) return 1;
+  if (!n_parent->all_parents_are_sliced()) return 1;
   return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+/** \struct Upwards_frame
+    Frame of the explicit depth-first traversal in upwards_slicing
+*/
+struct Upwards_frame {
+  const Gate * n;                              // /< current gate
+  const Gate * pre;                            // /< gate that gives the slice
+  std::list<Gate*>::const_iterator parent;     // /< next parent of n
+};
 
+// / work stack of upwards_slicing
+static thread_local std::vector<Upwards_frame> upwards_stack;
+
+static bool upwards_slicing(const Gate * n, const Gate * pre) {
+  if (n->get_slice() == -1 && pre->get_aig_output()) return 0;
+
+  upwards_stack.clear();
+  upwards_stack.push_back({n, pre, n->parents_begin()});
+  while (!upwards_stack.empty()) {
+    Upwards_frame & f = upwards_stack.back();
+    if (f.parent == f.n->parents_end()) {
+      upwards_stack.pop_back();
+      continue;
+    }
+    Gate * n_parent = *f.parent++;
+
+    int res = upwards_slice_parent(n_parent, f.pre);
+    if (res < 0) return 1;
+    if (res > 0)
+      upwards_stack.push_back({n_parent, n_parent, n_parent->parents_begin()});
+  }
+  return 0;
 }
 
 /*------------------------------------------------------------------------*/
 
 static bool slice_jut_gates() {
+  TRACE_SCOPE("slice_jut_gates");
   for (int i = NN-1; i >= 0; i--) {
     Gate * output = gates[i+M-1];
     output->set_slice(i);
@@ -323,17 +434,15 @@ const Gate * topological_largest_child(const Gate * n) {
       n_child->get_var_name(), n_child->get_slice());
   }
 
-  Gate * n1 = n->children_front();
-
-  for (auto it_s = slices[n1->get_slice()].begin();
-      it_s != slices[n1->get_slice()].end(); ++it_s) {
-    Gate * n_slice = *it_s;
-    for (auto it_n = n->children_begin(); it_n != n->children_end(); ++it_n) {
-      Gate * n_child = *it_n;
-      if (n_slice == n_child) return n_child;
-    }
+  // the child placed first in the slice
+  const Slice & sl = slices[slice];
+  const Gate * res = 0;
+  for (auto it_n = n->children_begin(); it_n != n->children_end(); ++it_n) {
+    Gate * n_child = *it_n;
+    if (!sl.contains(n_child)) continue;
+    if (!res || sl.precedes(n_child, res)) res = n_child;
   }
-  return 0;
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
@@ -345,21 +454,15 @@ void fix_slice(Gate * n, int i) {
   if (n->get_slice() != -1) slices[n->get_slice()].remove(n);
   if (n->get_elim()) return;
   n->set_slice(i);
-  for (std::list<Gate*>::const_iterator it = slices[i].begin();
-      it != slices[i].end(); ++it) {
-    Gate * n_it = *it;
-    if (n_it == after) {
-      msg("fix slice of %s",n->get_var_name());
-      slices[i].insert(it, n);
-      return;
-    }
-  }
   msg("fix slice of %s",n->get_var_name());
-  slices[i].push_back(n);
+  if (slices[i].contains(after)) slices[i].insert_before(after, n);
+  else
+    slices[i].push_back(n);
 }
 
 /*------------------------------------------------------------------------*/
 int fix_xors() {
+  TRACE_SCOPE("fix_xors");
   int counter = 0;
   for (unsigned i = NN; i < M-1; i++) {
     Gate * n = gates[i];
@@ -413,6 +516,7 @@ int fix_xors() {
 /*------------------------------------------------------------------------*/
 
 void fix_jut_gates() {
+  TRACE_SCOPE("fix_jut_gates");
   int counter = 0;
   for (unsigned i = NN; i < M-1; i++) {
     Gate * n = gates[i];
@@ -447,42 +551,54 @@ void fix_jut_gates() {
 /*------------------------------------------------------------------------*/
 
 bool slicing_xor() {
+  TRACE_SCOPE("slicing_xor");
 
   slice_by_xor_chains();
   if(slice_jut_gates()) return 1;
 
   for (int i=NN-1; i>= 0; i--) {
-  std::list<Gate*> sl = slices[i];
-  for (std::list<Gate*>::const_iterator it=sl.begin(); it != sl.end(); ++it) {
+  const Slice & sl = slices[i];
+  for (Slice::const_iterator it=sl.begin(); it != sl.end(); ++it) {
     Gate * n = *it;
     if (n->get_elim()) continue;
     }
   }
   if (fix_xors()) fix_jut_gates();
+  assert(slices_are_consistent());
 
   return 0;
 }
 
 /*------------------------------------------------------------------------*/
 
+// / work stack of input_cone
+static thread_local std::vector<Gate*> cone_stack;
+
 void input_cone(Gate * n, int num) {
-    assert(num >= 0);
-    if (n->get_input()) return;
-    if (n->get_slice() >= 0) return;
+  assert(num >= 0);
+  cone_stack.clear();
+  cone_stack.push_back(n);
+  while (!cone_stack.empty()) {
+    n = cone_stack.back();
+    cone_stack.pop_back();
+    // the slice marks the gates that have already been visited
+    if (n->get_input()) continue;
+    if (n->get_slice() >= 0) continue;
 
-    assert(n->get_slice() < 0);
     assert(is_model_and(n->get_var_num()));
     n->set_slice(num);
-    for (std::list<Gate*>::const_iterator it = n->children_begin();
-        it != n->children_end(); ++it) {
-      Gate * n_child = *it;
-      input_cone(n_child, num);
+    // push in reverse order to visit the children from first to last
+    for (std::list<Gate*>::const_reverse_iterator it = n->children_rbegin();
+        it != n->children_rend(); ++it) {
+      cone_stack.push_back(*it);
     }
+  }
 }
 
 /*------------------------------------------------------------------------*/
 
 void find_carries() {
+  TRACE_SCOPE("find_carries");
   for (unsigned j = M-1; j > NN; j--) {
     Gate * n = gates[j];
     if (n->get_elim()) continue;
@@ -500,6 +616,7 @@ void find_carries() {
 /*------------------------------------------------------------------------*/
 
 bool search_for_booth_pattern() {
+  TRACE_SCOPE("search_for_booth_pattern");
   bool found_booth = 0;
   for (unsigned i = NN; i < M-1; i++) {
     Gate * n = gates[i];
@@ -582,6 +699,7 @@ bool search_for_booth_pattern() {
 /*------------------------------------------------------------------------*/
 
 void merge_all() {
+  TRACE_SCOPE("merge_all");
   int total_merge = 0;
   int merged = 1;
   while (merged) {
@@ -644,6 +762,7 @@ void merge_all() {
 /*------------------------------------------------------------------------*/
 
 void promote_all() {
+  TRACE_SCOPE("promote_all");
   int total_promote = 0;
   int promoted = 1;
   while (promoted) {
@@ -701,6 +820,7 @@ void promote_all() {
 /*------------------------------------------------------------------------*/
 
 void fill_slices() {
+  TRACE_SCOPE("fill_slices");
   for (unsigned i = 0; i <= NN-1; i++) {
     for (unsigned j = M-2; j >= NN; j--) {
       Gate * n = gates[j];
@@ -715,6 +835,7 @@ void fill_slices() {
 /*------------------------------------------------------------------------*/
 
 void slicing_non_xor() {
+  TRACE_SCOPE("slicing_non_xor");
   for (unsigned i = 0; i < NN; i++){
     unsigned lit = slit(i);
     if(lit < 2) continue;
@@ -726,6 +847,7 @@ void slicing_non_xor() {
   merge_all();
   promote_all();
   fill_slices();
+  assert(slices_are_consistent());
 
   if (verbose > 3) print_slices();
 }
@@ -14,8 +14,131 @@
 
 #include "gate.h"
 /*------------------------------------------------------------------------*/
-// / vector-list Gate* matrix to store slices
-extern std::vector<std::list<Gate*>> slices;
+
+/** \class Slice
+    Ordered list of the gates of one slice. Every contained gate stores its
+    position and an order-maintenance label, thus removing a gate and
+    comparing the positions of two gates takes constant time.
+    A gate is contained in at most one slice, inserting a gate that is
+    already contained in a slice moves it, hence no gate appears twice in
+    the reduction order.
+*/
+class Slice {
+  // / index of the slice in slices
+  int idx;
+
+  // / gates in slice order
+  std::list<Gate*> gate_list;
+
+  /**
+      Assigns evenly spaced labels to all gates
+  */
+  void relabel();
+
+ public:
+  typedef std::list<Gate*>::const_iterator const_iterator;
+
+  /** Constructor
+
+      @param i integer index of the slice in slices
+  */
+  explicit Slice(int i): idx(i) {}
+
+  Slice(const Slice &) = delete;
+  Slice(Slice &&) = default;
+
+  /**
+      Getter for begin of the slice
+
+      @return const_iterator
+  */
+  const_iterator begin() const {return gate_list.begin();}
+
+  /**
+      Getter for end of the slice
+
+      @return const_iterator
+  */
+  const_iterator end() const {return gate_list.end();}
+
+  /**
+      Returns the number of gates in the slice
+
+      @return size_t
+  */
+  size_t size() const {return gate_list.size();}
+
+  /**
+      Returns the last gate of the slice
+
+      @return Gate*
+  */
+  Gate * back() const {return gate_list.back();}
+
+  /**
+      Checks whether n is contained in the slice
+
+      @param n const Gate*
+
+      @return True if n is contained in the slice
+  */
+  bool contains(const Gate * n) const {return n->pos_slice == idx;}
+
+  /**
+      Compares the positions of two contained gates
+
+      @param n1 const Gate*
+      @param n2 const Gate*
+
+      @return True if n1 comes before n2
+  */
+  bool precedes(const Gate * n1, const Gate * n2) const {
+    assert(contains(n1) && contains(n2));
+    return n1->pos_label < n2->pos_label;
+  }
+
+  /**
+      Inserts n before the position pos
+
+      @param pos const_iterator of this slice
+      @param n Gate*
+  */
+  void insert(const_iterator pos, Gate * n);
+
+  /**
+      Inserts n before the contained gate m
+
+      @param m const Gate*
+      @param n Gate*
+  */
+  void insert_before(const Gate * m, Gate * n) {
+    assert(contains(m));
+    insert(m->pos, n);
+  }
+
+  /**
+      Appends n to the end of the slice
+
+      @param n Gate*
+  */
+  void push_back(Gate * n) {insert(end(), n);}
+
+  /**
+      Removes n from the slice, does nothing if n is not contained
+
+      @param n Gate*
+  */
+  void remove(Gate * n);
+
+  /**
+      Removes the last gate of the slice
+  */
+  void pop_back() {remove(back());}
+};
+
+/*------------------------------------------------------------------------*/
+// / slices of gates, slices[i] contains the output s_i
+extern thread_local std::vector<Slice> slices;
 /*------------------------------------------------------------------------*/
 
 /**
@@ -29,6 +152,15 @@ void init_slices();
 */
 void print_slices();
 
+/**
+    Checks that every gate in slices[i] is assigned to slice i, which
+    decomposing and the reduction rely on, and that the labels increase
+    along each slice. Only used in assertions.
+
+    @return True if the slices are consistent
+*/
+bool slices_are_consistent();
+
 
 /**
     Returns the child that has the highest position in a slice
@@ -0,0 +1,493 @@
+/*------------------------------------------------------------------------*/
+/*! \file spill.cpp
+    \brief out-of-core remainder for reductions within a memory budget
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "checkpoint.h"
+#include "elimination.h"
+#include "progress.h"
+#include "resource_limits.h"
+#include "spill.h"
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_spill = 181;  // cannot write or read spill file
+/*------------------------------------------------------------------------*/
+// Global variables
+thread_local double spill_memory = 0;
+
+/*------------------------------------------------------------------------*/
+// Local variables
+
+// / estimated memory of a monomial of the remainder in bytes, including
+// / its share of the terms and the copy made by add_poly
+static const double bytes_per_monomial = 256;
+
+// / maximal number of runs of a slice before they are merged early
+static const size_t max_runs = 64;
+
+/** \struct Spill_run
+    Sorted run of monomials in an unlinked temporary file
+*/
+struct Spill_run {
+  FILE * file = 0;       // /< temporary file, 0 if the run is empty
+  uint64_t size = 0;     // /< number of monomials
+};
+
+// / the spilled remainder, file is 0 if the remainder is in memory
+static thread_local Spill_run spilled;
+
+// / runs written in the current slice
+static thread_local std::vector<Spill_run> runs;
+
+// / reduced monomials which are not yet written to a run
+static thread_local std::vector<Monomial*> buffer;
+
+// / variables written to a run since the start of the last pass, indexed
+// / as gates, over-approximates the variables of the spilled remainder
+static thread_local std::vector<bool> occurs;
+
+// / number of slices reduced out of core
+static thread_local unsigned spilled_slices = 0;
+
+// / number of passes over the spilled remainder
+static thread_local uint64_t spilled_passes = 0;
+
+// / number of runs and monomials written
+static thread_local uint64_t spilled_runs = 0, spilled_monomials = 0;
+
+// / largest spilled remainder
+static thread_local uint64_t max_spilled = 0;
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Returns the maximal number of monomials kept in memory
+
+    @return size_t
+*/
+static size_t spill_limit() {
+  size_t res = spill_memory * (1 << 20) / bytes_per_monomial;
+  return res ? res : 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+bool spill_remainder(const Polynomial * rem) {
+  if (spill_memory <= 0 || proof) return 0;
+  if (spilled.file) return 1;
+  return rem && rem->size() > spill_limit();
+}
+
+/*------------------------------------------------------------------------*/
+// Compares terms in the order of polynomials, the constant term is smallest
+static int compare_terms(const Term * s, const Term * t) {
+  if (s == t) return 0;
+  if (!s) return -1;
+  if (!t) return 1;
+  return s->cmp(t);
+}
+
+/*------------------------------------------------------------------------*/
+// Index of the gate of v in gates
+static size_t var_index(const Var * v) {
+  int num = v->get_num();
+  return num > 0 ? num/2 - 1 : M - 1 - num;
+}
+
+/*------------------------------------------------------------------------*/
+// Checks whether the term lt divides the term t
+static bool divides(const Term * lt, const Term * t) {
+  for (; lt; lt = lt->get_rest())
+    if (!t || !t->contains(lt->get_var())) return 0;
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Creates an empty run in an unlinked temporary file
+
+    @return Spill_run
+*/
+static Spill_run new_run() {
+  const char * dir = getenv("TMPDIR");
+  if (!dir || !*dir) dir = "/tmp";
+  std::string name = std::string(dir) + "/amulet-spill-XXXXXX";
+  int fd = mkstemp(&name[0]);
+  if (fd < 0) die(err_spill, "can not create spill file in '%s'", dir);
+  unlink(name.c_str());
+
+  Spill_run res;
+  res.file = fdopen(fd, "w+");
+  if (!res.file) die(err_spill, "can not open spill file in '%s'", dir);
+  setvbuf(res.file, 0, _IOFBF, 1 << 20);
+  spilled_runs++;
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Appends m to the run and deallocates m
+
+    @param run Spill_run &
+    @param m Monomial*
+*/
+static void append_to_run(Spill_run & run, Monomial * m) {
+  if (!write_monomial(run.file, m))
+    die(err_spill, "can not write spill file");
+  for (const Term * t = m->get_term(); t; t = t->get_rest())
+    occurs[var_index(t->get_var())] = 1;
+  deallocate_monomial(m);
+  run.size++;
+  spilled_monomials++;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Reads the next monomial of a run
+
+    @param run Spill_run &
+
+    @return Monomial*
+*/
+static Monomial * read_from_run(Spill_run & run) {
+  Monomial * res = read_monomial(run.file);
+  if (!res) die(err_spill, "can not read spill file");
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Adds the coefficient of m to coeff, reduced modulo 2^NN if xor_chain
+    is set, and deallocates m
+
+    @param coeff mpz_t
+    @param m Monomial*
+*/
+static void add_coeff(mpz_t coeff, Monomial * m) {
+  mpz_add(coeff, coeff, m->coeff);
+  if (xor_chain) mpz_tdiv_r_2exp(coeff, coeff, NN);
+  deallocate_monomial(m);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Sorts the buffer in the order of polynomials and merges monomials with
+    equal terms
+*/
+static void sort_buffer() {
+  std::sort(buffer.begin(), buffer.end(),
+    [](const Monomial * m1, const Monomial * m2) {
+      return compare_terms(m1->get_term(), m2->get_term()) > 0;
+    });
+
+  mpz_t coeff;
+  mpz_init(coeff);
+  size_t j = 0;
+  for (size_t i = 0; i < buffer.size(); ) {
+    Term * t = buffer[i]->get_term();
+    size_t k = i + 1;
+    while (k < buffer.size() &&
+        !compare_terms(buffer[k]->get_term(), t)) k++;
+
+    if (k == i + 1) {
+      buffer[j++] = buffer[i];
+    } else {
+      mpz_set_ui(coeff, 0);
+      Term * tc = t ? t->copy() : 0;
+      for (size_t l = i; l < k; l++) add_coeff(coeff, buffer[l]);
+      if (mpz_sgn(coeff)) buffer[j++] = new Monomial(coeff, tc);
+      else if (tc)
+        deallocate_term(tc);
+    }
+    i = k;
+  }
+  buffer.resize(j);
+  mpz_clear(coeff);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Writes the sorted buffer as new run of the current slice
+*/
+static void flush_buffer() {
+  sort_buffer();
+  if (buffer.empty()) return;
+  Spill_run run = new_run();
+  for (size_t i = 0; i < buffer.size(); i++) append_to_run(run, buffer[i]);
+  buffer.clear();
+  runs.push_back(run);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Merges all runs of the current slice into a single run
+
+    @return Spill_run, the merged run
+*/
+static Spill_run merge_runs() {
+  size_t j = 0;
+  for (size_t i = 0; i < runs.size(); i++) {
+    if (runs[i].size) runs[j++] = runs[i];
+    else
+      fclose(runs[i].file);
+  }
+  runs.resize(j);
+  if (runs.empty()) return new_run();
+  if (runs.size() == 1) {
+    Spill_run res = runs[0];
+    runs.clear();
+    return res;
+  }
+
+  typedef std::pair<Monomial*, size_t> Head;
+  auto smaller = [](const Head & h1, const Head & h2) {
+    return compare_terms(h1.first->get_term(), h2.first->get_term()) < 0;
+  };
+  std::priority_queue<Head, std::vector<Head>, decltype(smaller)>
+    heads(smaller);
+
+  std::vector<uint64_t> left(runs.size());
+  for (size_t i = 0; i < runs.size(); i++) {
+    rewind(runs[i].file);
+    left[i] = runs[i].size - 1;
+    heads.push(Head(read_from_run(runs[i]), i));
+  }
+
+  Spill_run res = new_run();
+  mpz_t coeff;
+  mpz_init(coeff);
+  while (!heads.empty()) {
+    Term * t = heads.top().first->get_term();
+    Term * tc = t ? t->copy() : 0;
+    mpz_set_ui(coeff, 0);
+    while (!heads.empty() &&
+        !compare_terms(heads.top().first->get_term(), t)) {
+      Head h = heads.top();
+      heads.pop();
+      add_coeff(coeff, h.first);
+      if (left[h.second]) {
+        left[h.second]--;
+        heads.push(Head(read_from_run(runs[h.second]), h.second));
+      }
+    }
+    if (mpz_sgn(coeff)) append_to_run(res, new Monomial(coeff, tc));
+    else if (tc)
+      deallocate_term(tc);
+  }
+  mpz_clear(coeff);
+
+  for (size_t i = 0; i < runs.size(); i++) fclose(runs[i].file);
+  runs.clear();
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Adds the monomial to the buffer, flushes the buffer if it is full
+
+    @param m Monomial*
+*/
+static void push_buffer(Monomial * m) {
+  buffer.push_back(m);
+  if (buffer.size() < spill_limit()) return;
+  flush_buffer();
+  if (runs.size() < max_runs) return;
+  Spill_run run = merge_runs();
+  runs.push_back(run);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Writes the in-memory polynomial p as the spilled remainder and deletes p
+
+    @param p Polynomial*
+*/
+static void spill_polynomial(Polynomial * p) {
+  assert(!spilled.file);
+  std::fill(occurs.begin(), occurs.end(), 0);
+  spilled = new_run();
+  for (size_t j = 0; j < p->size(); j++)
+    append_to_run(spilled, p->get_mon(j)->copy());
+  delete(p);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Reads the spilled remainder into memory
+
+    @return Polynomial*
+*/
+static Polynomial * load_spilled() {
+  rewind(spilled.file);
+  for (uint64_t j = 0; j < spilled.size; j++)
+    push_mstack_end(read_from_run(spilled));
+  fclose(spilled.file);
+  spilled = Spill_run();
+  return build_poly();
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Finishes a pass, the runs of the pass are merged into the spilled
+    remainder
+*/
+static void finish_pass() {
+  flush_buffer();
+  spilled = merge_runs();
+  if (spilled.size > max_spilled) max_spilled = spilled.size;
+  spilled_passes++;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Adds the polynomial p to the spilled remainder and deletes p
+
+    @param p Polynomial*
+*/
+static void add_out_of_core(Polynomial * p) {
+  runs.push_back(spilled);
+  spilled = Spill_run();
+  for (size_t j = 0; j < p->size(); j++) push_buffer(p->get_mon(j)->copy());
+  delete(p);
+  finish_pass();
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Reduces the spilled remainder by the gate constraint of n in one pass.
+    Monomials that are not divisible by the leading term of the gate
+    constraint are copied to a new run in order, the others are reduced and
+    collected in the buffer.
+
+    @param n Gate*
+*/
+static void reduce_out_of_core(Gate * n) {
+  const Term * lt = n->get_gate_constraint()->get_lt();
+  for (const Term * t = lt; t; t = t->get_rest())
+    if (!occurs[var_index(t->get_var())]) return;
+
+  std::fill(occurs.begin(), occurs.end(), 0);
+  Spill_run rest = new_run();
+  rewind(spilled.file);
+  for (uint64_t j = 0; j < spilled.size; j++) {
+    Monomial * m = read_from_run(spilled);
+    if (!divides(lt, m->get_term())) {
+      append_to_run(rest, m);
+      continue;
+    }
+    push_mstack_end(m);
+    Polynomial * p = build_poly();
+    Polynomial * tmp = reduce_by_one_poly(p, n, 0);
+    if (xor_chain) tmp = mod_poly(tmp, 0, 0);
+    delete(p);
+    for (size_t k = 0; k < tmp->size(); k++)
+      push_buffer(tmp->get_mon(k)->copy());
+    delete(tmp);
+  }
+  fclose(spilled.file);
+  spilled = Spill_run();
+
+  runs.push_back(rest);
+  finish_pass();
+}
+
+/*------------------------------------------------------------------------*/
+
+Polynomial * reduce_slice_out_of_core(
+    int i, const Gate * last, Polynomial * rem, Polynomial * spec) {
+  assert(!proof);
+  occurs.resize(num_gates);
+  if (!spilled.file && !spilled_slices)
+    msg("remainder of %zu monomials exceeds the memory budget of %g MB, "
+      "reducing out of core", rem ? rem->size() : 0, spill_memory);
+  spilled_slices++;
+
+  if (rem) spill_polynomial(rem);
+  if (spec) add_out_of_core(spec);
+  rem = 0;
+
+  const Slice & sl = slices[i];
+  for (Slice::const_iterator it = sl.begin(); it != sl.end(); ++it) {
+    Gate * n = *it;
+    if (n->get_elim()) continue;
+    if (last && !sl.precedes(last, n)) continue;
+
+    if (!rem && spilled.size <= spill_limit()) rem = load_spilled();
+
+    if (rem) {
+      Polynomial * tmp = reduce_by_one_poly(rem, n, 0);
+      if (xor_chain) tmp = mod_poly(tmp, 0, 0);
+      delete(rem);
+      rem = tmp;
+      if (rem->size() > spill_limit()) {
+        spill_polynomial(rem);
+        rem = 0;
+      }
+    } else {
+      reduce_out_of_core(n);
+    }
+
+    delete(n->get_gate_constraint());
+    n->set_gate_constraint(0);
+    check_resource_limits(i, rem);
+    report_progress(i, rem);
+  }
+
+  if (!rem && spilled.size <= spill_limit()) rem = load_spilled();
+  if (verbose >= 1 && !rem)
+    msg("spilled remainder after slice %i has %llu monomials", i,
+      static_cast<unsigned long long>(spilled.size));
+  return rem;
+}
+
+/*------------------------------------------------------------------------*/
+
+uint64_t spilled_size() { return spilled.file ? spilled.size : 0; }
+
+/*------------------------------------------------------------------------*/
+
+Polynomial * finish_spilling(Polynomial * rem) {
+  if (spilled.file) {
+    assert(!rem);
+    rem = load_spilled();
+  }
+
+  if (spilled_slices) {
+    msg("reduced %u slices out of core in %llu passes", spilled_slices,
+      static_cast<unsigned long long>(spilled_passes));
+    msg("wrote %llu monomials to %llu runs, largest spilled remainder "
+      "had %llu monomials", static_cast<unsigned long long>(spilled_monomials),
+      static_cast<unsigned long long>(spilled_runs),
+      static_cast<unsigned long long>(max_spilled));
+  }
+  spilled_slices = 0;
+  spilled_passes = spilled_runs = spilled_monomials = max_spilled = 0;
+  occurs.clear();
+  return rem;
+}
@@ -0,0 +1,77 @@
+/*------------------------------------------------------------------------*/
+/*! \file spill.h
+    \brief out-of-core remainder for reductions within a memory budget
+
+  If the remainder exceeds the memory budget, reduce continues out of
+  core. The remainder is then kept as a sorted run of monomials on disk and
+  every gate constraint of the slice is applied in one streaming pass:
+  monomials that do not contain the gate variable are copied in order,
+  the others are reduced and collected in a bounded buffer. A full buffer
+  is sorted, equal terms are merged and it is written as a further sorted
+  run. At the end of the pass all runs are merged into the new remainder.
+  Passes are skipped for gates whose variable has not been written since
+  the last pass. As soon as the remainder fits the budget again it is
+  moved back into memory.
+
+  Runs are unlinked temporary files in the directory $TMPDIR, or '/tmp'.
+  The out-of-core reduction is only used in '-verify'.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_SPILL_H_
+#define AMULET2_SRC_SPILL_H_
+/*------------------------------------------------------------------------*/
+#include "slicing.h"
+/*------------------------------------------------------------------------*/
+// / Memory budget for the remainder in MB, the remainder is never spilled
+// / to disk if 0
+extern thread_local double spill_memory;
+
+/**
+    Checks whether the remainder has to be reduced out of core, i.e.,
+    whether it is already on disk or has outgrown the memory budget
+
+    @param rem const Polynomial*, in-memory remainder, may be 0
+
+    @return true if the next reduction step has to be done out of core
+*/
+bool spill_remainder(const Polynomial * rem);
+
+/**
+    Reduces rem + spec by the gates of slice i following the gate last.
+    If rem is 0 and the remainder is spilled, the remainder is read from
+    disk. Deletes rem and spec.
+
+    @param i integer, index of the slice
+    @param last const Gate*, last gate of the slice that rem is already
+                reduced by, 0 if rem is not reduced by slice i
+    @param rem Polynomial*, may be 0
+    @param spec Polynomial*, may be 0
+
+    @return Polynomial*, the reduced remainder if it fits the memory budget,
+            otherwise 0 and the reduced remainder is spilled to disk
+*/
+Polynomial * reduce_slice_out_of_core(
+  int i, const Gate * last, Polynomial * rem, Polynomial * spec);
+
+/**
+    Returns the number of monomials of the spilled remainder
+
+    @return uint64_t, 0 if the remainder is in memory
+*/
+uint64_t spilled_size();
+
+/**
+    Loads the spilled remainder into memory and prints statistics, if the
+    remainder has been spilled during the reduction
+
+    @param rem Polynomial*, in-memory remainder, returned if the remainder
+               is not spilled
+
+    @return Polynomial*, the final remainder
+*/
+Polynomial * finish_spilling(Polynomial * rem);
+
+#endif  // AMULET2_SRC_SPILL_H_
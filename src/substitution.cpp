@@ -7,6 +7,9 @@
 */
 /*------------------------------------------------------------------------*/
 #include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "substitution.h"
 /*------------------------------------------------------------------------*/
@@ -15,19 +18,28 @@ static int err_miter = 71; // error in miter
 /*------------------------------------------------------------------------*/
 // Local variables
 
-unsigned aig_idx;
-
-bool no_cin;
-bool single_gen_gate;
-
-static Gate * carry_out;
-static Gate * carry_in;
-static std::vector<Gate*> outputs;
-static std::vector<unsigned> original_outputs;
-static std::vector<unsigned> rewritten_outputs;
-static std::vector<Gate*> inputs;
-static std::list<unsigned>plain_inputs;
-static std::vector<Gate*> c_ins;
+thread_local unsigned aig_idx;
+
+thread_local bool no_cin;
+thread_local bool single_gen_gate;
+
+static thread_local Gate * carry_out;
+static thread_local Gate * carry_in;
+static thread_local std::vector<Gate*> outputs;
+static thread_local std::vector<unsigned> original_outputs;
+static thread_local std::vector<unsigned> rewritten_outputs;
+static thread_local std::vector<Gate*> inputs;
+static thread_local std::list<unsigned>plain_inputs;
+static thread_local std::vector<Gate*> c_ins;
+
+// / structural hash table of the miter, maps the ordered inputs to the and
+static thread_local std::unordered_map<uint64_t, unsigned> miter_strash;
+// / inputs of the ands in the miter, indexed by the variable of the and
+static thread_local std::vector<std::pair<unsigned, unsigned>> miter_ands;
+// / miter literals of the btor adder ands, indexed by variable - btor_var
+static thread_local std::vector<unsigned> btor_to_miter;
+// / first variable of the btor adder
+static thread_local unsigned btor_var;
 /*------------------------------------------------------------------------*/
 
 bool all_single_output() {
@@ -230,7 +242,7 @@ void fix_inputs() {
   if (!cin_in_slice_0() && !signed_mult) return;
   if (!cin_in_slice_0() && all_single_output()) return;
 
-  static std::vector<Gate*> inputs_cpy;
+  static thread_local std::vector<Gate*> inputs_cpy;
   for (std::vector<Gate*>::const_iterator it = inputs.begin();
       it != inputs.end(); ++it) {
     Gate * n = *it;
@@ -254,28 +266,39 @@ void fix_inputs() {
 
 /*------------------------------------------------------------------------*/
 
+// / work stack of follow_path_and_mark_gates, stores the gates together
+// / with the literal pointing to them, which is 0 for the root
+static thread_local std::vector<std::pair<Gate*, unsigned>> path_stack;
+
 bool follow_path_and_mark_gates(Gate * n, bool init) {
-  if (n->get_input() && !n->get_fsa_inp()) return 0;
+  unsigned epoch = new_visit_epoch();
+  path_stack.clear();
+  path_stack.push_back(std::make_pair(n, 0u));
+
+  // depth-first, right child before left child
+  while (!path_stack.empty()) {
+    n = path_stack.back().first;
+    unsigned lit = path_stack.back().second;
+    path_stack.pop_back();
+
+    if (lit && !n->get_prop_gen_gate() && carry_in == n && init &&
+        !n->get_neg()) {
+      n->set_neg(aiger_sign(lit));
+    }
 
-  n->mark_fsa();
-  if (n == carry_in) return 1;
-  if (n->get_fsa_inp()) return 1;
+    // all paths below a visited gate have already been checked
+    if (!n->visit(epoch)) continue;
 
-  aiger_and * and1 = is_model_and(n->get_var_num());
-  Gate * l = gate(and1->rhs0);
-  Gate * r = gate(and1->rhs1);
+    if (n->get_input() && !n->get_fsa_inp()) return 0;
 
-  if (!r->get_prop_gen_gate() && carry_in == r && init  && !r->get_neg()) {
-     r->set_neg(aiger_sign(and1->rhs1));
-  }
-  if (!follow_path_and_mark_gates(r, init)) return 0;
+    n->mark_fsa();
+    if (n == carry_in) continue;
+    if (n->get_fsa_inp()) continue;
 
-  if (!l->get_prop_gen_gate() && carry_in == l && init && !l->get_neg()) {
-     l->set_neg(aiger_sign(and1->rhs0));
+    aiger_and * and1 = is_model_and(n->get_var_num());
+    path_stack.push_back(std::make_pair(gate(and1->rhs0), and1->rhs0));
+    path_stack.push_back(std::make_pair(gate(and1->rhs1), and1->rhs1));
   }
-  if (!follow_path_and_mark_gates(l, init)) return 0;
-
-
   return 1;
 }
 
@@ -328,9 +351,23 @@ void correctly_mark_inputs() {
     }
 }
 
+/*------------------------------------------------------------------------*/
+// Clears the adder found by a previous substitution on this thread
+static void reset_final_stage_adder() {
+  carry_in = carry_out = 0;
+  no_cin = single_gen_gate = 0;
+  outputs.clear();
+  inputs.clear();
+  plain_inputs.clear();
+  c_ins.clear();
+  original_outputs.clear();
+  rewritten_outputs.clear();
+}
+
 /*------------------------------------------------------------------------*/
 
 bool identify_final_stage_adder() {
+  reset_final_stage_adder();
   if (!all_outputs_are_xor()) {
     msg("substitution not possible - not all outputs are XORs");
     return 0;
@@ -356,6 +393,106 @@ bool identify_final_stage_adder() {
 
   return 1;
 }
+/*----------------------------------------------------------------------------*/
+
+/**
+    Returns the key of the and with inputs a and b in the structural hash
+    table, the key does not depend on the order of the inputs
+
+    @param a unsigned integer
+    @param b unsigned integer
+
+    @return uint64_t
+*/
+static uint64_t strash_key(unsigned a, unsigned b) {
+  if (a > b) std::swap(a, b);
+  return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+    Adds the and lhs = a & b to the miter and to its structural hash table
+
+    @param lhs unsigned integer, even
+    @param a unsigned integer
+    @param b unsigned integer
+*/
+static void add_miter_and(unsigned lhs, unsigned a, unsigned b) {
+  assert(!aiger_sign(lhs));
+  aiger_add_and(miter, lhs, a, b);
+  miter_strash[strash_key(a, b)] = lhs;
+
+  unsigned v = aiger_lit2var(lhs);
+  if (v >= miter_ands.size()) miter_ands.resize(v+1, std::make_pair(0, 0));
+  miter_ands[v] = std::make_pair(a, b);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+    Looks up the inputs of an and in the miter
+
+    @param a unsigned integer
+    @param a0 unsigned integer, set to the first input
+    @param a1 unsigned integer, set to the second input
+
+    @return true if the variable of a is an and in the miter
+*/
+static bool miter_and_inputs(unsigned a, unsigned & a0, unsigned & a1) {
+  unsigned v = aiger_lit2var(a);
+  if (v >= miter_ands.size() || !miter_ands[v].first) return 0;
+  a0 = miter_ands[v].first;
+  a1 = miter_ands[v].second;
+  return 1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+    Translates a literal of the btor adder to the corresponding miter literal,
+    literals of the original AIG are returned unchanged
+
+    @param a unsigned integer
+
+    @return unsigned integer
+*/
+static unsigned miter_lit(unsigned a) {
+  if (aiger_lit2var(a) < btor_var) return a;
+  unsigned res = btor_to_miter[aiger_lit2var(a) - btor_var];
+  return aiger_sign(a) ? not_(res) : res;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+    Adds the and lhs = rhs0 & rhs1 of the btor adder to the rewritten AIG,
+    and its simplified and hashed counterpart to the miter
+
+    @param lhs unsigned integer, even
+    @param rhs0 unsigned integer
+    @param rhs1 unsigned integer
+*/
+static void btor_and(unsigned lhs, unsigned rhs0, unsigned rhs1) {
+  aiger_add_and(rewritten, lhs, rhs0, rhs1);
+
+  unsigned v = aiger_lit2var(lhs) - btor_var;
+  if (v >= btor_to_miter.size()) btor_to_miter.resize(v+1, 0);
+  btor_to_miter[v] = and_(miter_lit(rhs0), miter_lit(rhs1));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+    Clears the structural hash table of the miter
+*/
+static void reset_miter_strash() {
+  miter_strash.clear();
+  miter_ands.clear();
+  btor_to_miter.clear();
+  btor_var = aiger_lit2var(2*get_model_maxvar()+2);
+}
+
 /*----------------------------------------------------------------------------*/
 void add_original_adder() {
   for (unsigned i = 0; i < M-1; i++) {
@@ -368,7 +505,7 @@ void add_original_adder() {
       if (verbose >= 3) msg("miter input %s", n->get_var_name());
     } else {
       aiger_and * and1 = is_model_and(n->get_var_num());
-      aiger_add_and(miter, and1->lhs, and1->rhs0, and1->rhs1);
+      add_miter_and(and1->lhs, and1->rhs0, and1->rhs1);
       if (verbose >= 4)
         msg("original adder and %i %i %i", and1->lhs, and1->rhs0, and1->rhs1);
     }
@@ -409,13 +546,9 @@ unsigned btor_ha(unsigned i1, unsigned i2, bool carry) {
   two = one + 2;
   three = two + 2;
 
-  aiger_add_and(miter, one, not_(i1), not_(i2));
-  aiger_add_and(miter, two, i1, i2);
-  aiger_add_and(miter, three, not_(one), not_(two));
-
-  aiger_add_and(rewritten, one, not_(i1), not_(i2));
-  aiger_add_and(rewritten, two, i1, i2);
-  aiger_add_and(rewritten, three, not_(one), not_(two));
+  btor_and(one, not_(i1), not_(i2));
+  btor_and(two, i1, i2);
+  btor_and(three, not_(one), not_(two));
 
   aig_idx = aig_idx + 6;
   if (carry) {
@@ -441,28 +574,19 @@ unsigned btor_fa(unsigned i1, unsigned i2, unsigned i3, bool carry) {
   five = four + 2;
   six = five +2;
 
-  aiger_add_and(miter, one, not_(i1), not_(i2));
-  aiger_add_and(miter, two, i1, i2);
-  aiger_add_and(miter, three, not_(one), not_(two));
-  aiger_add_and(miter, four, not_(i3), not_(three));
-  aiger_add_and(miter, five, i3, three);
-  aiger_add_and(miter, six, not_(four), not_(five));
-
-
-  aiger_add_and(rewritten, one, not_(i1), not_(i2));
-  aiger_add_and(rewritten, two, i1, i2);
-  aiger_add_and(rewritten, three, not_(one), not_(two));
-  aiger_add_and(rewritten, four, not_(i3), not_(three));
-  aiger_add_and(rewritten, five, i3, three);
-  aiger_add_and(rewritten, six, not_(four), not_(five));
+  btor_and(one, not_(i1), not_(i2));
+  btor_and(two, i1, i2);
+  btor_and(three, not_(one), not_(two));
+  btor_and(four, not_(i3), not_(three));
+  btor_and(five, i3, three);
+  btor_and(six, not_(four), not_(five));
 
   aig_idx = aig_idx + 12;
   rewritten_outputs.push_back(six);
 
   if (carry) {
     unsigned seven = six + 2;
-    aiger_add_and(miter, seven, not_(two), not_(five));
-    aiger_add_and(rewritten, seven, not_(two), not_(five));
+    btor_and(seven, not_(two), not_(five));
     aig_idx = aig_idx + 2;
     if (verbose >= 2)
       msg("fa with outputs %i, %i, inputs  %i, %i, %i", seven, six, i1, i2, i3);
@@ -578,14 +702,96 @@ void add_btor_adder() {
 /*----------------------------------------------------------------------------*/
 unsigned not_(unsigned a) { return a^1; }
 /*------------------------------------------------------------------------*/
+/**
+    Applies the one-level rules to a & b, where only a is an and in the miter
+
+    @param a unsigned integer, and with inputs a0 and a1
+    @param b unsigned integer
+    @param a0 unsigned integer
+    @param a1 unsigned integer
+    @param res unsigned integer, set to the simplified result
+
+    @return true if a rule could be applied
+*/
+static bool simplify_one_level(
+  unsigned a, unsigned b, unsigned a0, unsigned a1, unsigned & res) {
+  if (!aiger_sign(a)) {
+    // contradiction: (a0 & a1) & !a0 = 0
+    if (b == not_(a0) || b == not_(a1)) { res = 0; return 1; }
+    // idempotence: (a0 & a1) & a0 = (a0 & a1)
+    if (b == a0 || b == a1) { res = a; return 1; }
+  } else {
+    // subsumption: !(a0 & a1) & !a0 = !a0
+    if (b == not_(a0) || b == not_(a1)) { res = b; return 1; }
+    // substitution: !(a0 & a1) & a0 = a0 & !a1
+    if (b == a0) { res = and_(b, not_(a1)); return 1; }
+    if (b == a1) { res = and_(b, not_(a0)); return 1; }
+  }
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Applies the two-level rules to a & b, where both are ands in the miter
+
+    @param a unsigned integer, and with inputs a0 and a1
+    @param b unsigned integer, and with inputs b0 and b1
+    @param a0 unsigned integer
+    @param a1 unsigned integer
+    @param b0 unsigned integer
+    @param b1 unsigned integer
+    @param res unsigned integer, set to the simplified result
+
+    @return true if a rule could be applied
+*/
+static bool simplify_two_level(unsigned a, unsigned b,
+  unsigned a0, unsigned a1, unsigned b0, unsigned b1, unsigned & res) {
+  if (!aiger_sign(a) && !aiger_sign(b)) {
+    // contradiction: (a0 & a1) & (!a0 & b1) = 0
+    if (a0 == not_(b0) || a0 == not_(b1) || a1 == not_(b0) ||
+        a1 == not_(b1)) {
+      res = 0;
+      return 1;
+    }
+  } else if (aiger_sign(a) && aiger_sign(b)) {
+    // resolution: !(x & y) & !(x & !y) = !x
+    if ((a0 == b0 && a1 == not_(b1)) || (a0 == b1 && a1 == not_(b0))) {
+      res = not_(a0);
+      return 1;
+    }
+    if ((a1 == b1 && a0 == not_(b0)) || (a1 == b0 && a0 == not_(b1))) {
+      res = not_(a1);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
 unsigned and_(unsigned a, unsigned b) {
   unsigned res;
   if (!a || !b || a == not_(b)) return 0;
   if (a == 1 || a == b) return b;
   if (b == 1) return a;
+
+  unsigned a0 = 0, a1 = 0, b0 = 0, b1 = 0;
+  bool a_is_and = miter_and_inputs(a, a0, a1);
+  bool b_is_and = miter_and_inputs(b, b0, b1);
+  if (a_is_and && simplify_one_level(a, b, a0, a1, res)) return res;
+  if (b_is_and && simplify_one_level(b, a, b0, b1, res)) return res;
+  if (a_is_and && b_is_and &&
+      simplify_two_level(a, b, a0, a1, b0, b1, res)) return res;
+
+  std::unordered_map<uint64_t, unsigned>::const_iterator it =
+    miter_strash.find(strash_key(a, b));
+  if (it != miter_strash.end()) return it->second;
+
   res = 2*(miter->maxvar + 1);
+  if (res < 2*btor_var) res = 2*btor_var;
   assert(a < res), assert(b < res);
-  aiger_add_and(miter, res, a, b);
+  add_miter_and(res, a, b);
   if (verbose >= 4) msg("miter and %i %i %i", res, a, b);
   return res;
 }
@@ -627,7 +833,8 @@ bool build_miter() {
 
   unsigned out = 1;
   for (unsigned i = 0; i < outputs.size(); i++)
-    out = and_(out, xnor_(original_outputs[i], rewritten_outputs[i]));
+    out = and_(out,
+      xnor_(original_outputs[i], miter_lit(rewritten_outputs[i])));
 
   aiger_add_output(miter, not_(out), "miter");
   return 1;
@@ -638,6 +845,7 @@ bool build_miter() {
 bool build_adder_miter() {
   msg("build adder miter");
 
+  reset_miter_strash();
   add_original_adder();
   fill_original_outputs();
   add_btor_adder();
@@ -693,30 +901,29 @@ bool miter_to_file(FILE * file) {
     if (refs[lit+1]) n += 1;
   }
 
-  fprintf(file, "p cnf %i %i\n", m, n);
+  Dimacs_writer writer(file);
+  writer.header(m, n);
   if (verbose >= 2) msg("p cnf %i %i", m, n);
 
-  if (refs[0] || refs[1]) fprintf(file, "%d 0\n", map[1]);
+  if (refs[0] || refs[1]) writer.clause(map[1]);
 
   for (i = 0; i < miter->num_ands; i++) {
     lit = miter->ands[i].lhs;
     if (refs[lit]) {
-      fprintf(file, "%d %d 0\n",
-      map[aiger_not(lit)], map[miter->ands[i].rhs1]);
-      fprintf(file, "%d %d 0\n",
-      map[aiger_not(lit)], map[miter->ands[i].rhs0]);
+      writer.clause(map[aiger_not(lit)], map[miter->ands[i].rhs1]);
+      writer.clause(map[aiger_not(lit)], map[miter->ands[i].rhs0]);
     }
     if (refs[lit+1]) {
-      fprintf(file, "%d %d %d 0\n", map[lit],
+      writer.clause(map[lit],
       map[aiger_not(miter->ands[i].rhs1)],
       map[aiger_not(miter->ands[i].rhs0)]);
     }
   }
 
-  fprintf(file, "%d 0\n", map[miter->outputs[0].lit]);
+  writer.clause(map[miter->outputs[0].lit]);
   free(refs);
   free(map);
-  return 1;
+  return writer.flush();
 }
 
 /*------------------------------------------------------------------------*/
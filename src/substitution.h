@@ -11,6 +11,7 @@
 /*------------------------------------------------------------------------*/
 #include <vector>
 
+#include "dimacs_writer.h"
 #include "gate.h"
 /*------------------------------------------------------------------------*/
 
@@ -193,7 +194,10 @@ void add_btor_adder();
 unsigned not_(unsigned a);
 
 /**
-    Generates an AIG gate with inputs a and b
+    Generates an AIG gate with inputs a and b in the miter. Constant inputs,
+    one- and two-level rules (contradiction, idempotence, subsumption,
+    substitution, resolution) and the structural hash table of the miter
+    are used to avoid adding redundant gates
 
     @param a unsigned integer
     @param b unsigned integer
@@ -6,12 +6,19 @@
   Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
 */
 /*------------------------------------------------------------------------*/
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "substitution_engine.h"
 
 /*------------------------------------------------------------------------*/
 // ERROR CODES:
 static int err_write_file  = 51; // error write to file
 static int err_write_aig   = 52; // error write aig
+static int err_not_equal   = 53; // adder differs from its replacement
 /*------------------------------------------------------------------------*/
 void init_gate_substitution() {
   allocate_gates();
@@ -22,38 +29,145 @@ void init_gate_substitution() {
 
 /*------------------------------------------------------------------------*/
 
+// / process compressing the CNF output file, 0 if it is not gzipped
+static thread_local pid_t gzip_pid = 0;
+
+/**
+    Opens the CNF output file. If the file name ends in ".gz" the file is
+    opened here and a 'gzip -c' child process writes to it, which reads the
+    CNF from a pipe. No shell is involved, so any file name is safe.
+
+    @param name char * name of the file
+
+    @return FILE *, 0 if the file cannot be opened
+*/
+static FILE * open_cnf_file(const char * name) {
+  size_t len = strlen(name);
+  gzip_pid = 0;
+  if (len < 3 || strcmp(name + len - 3, ".gz")) return fopen(name, "w");
+
+  int fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) return 0;
+  int fds[2];
+  if (pipe(fds)) { close(fd); return 0; }
+
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) {
+    close(fd);
+    close(fds[0]);
+    close(fds[1]);
+    return 0;
+  }
+  if (!pid) {
+    dup2(fds[0], 0);
+    dup2(fd, 1);
+    close(fds[0]);
+    close(fds[1]);
+    close(fd);
+    execlp("gzip", "gzip", "-c", static_cast<char*>(0));
+    _exit(127);
+  }
+  close(fds[0]);
+  close(fd);
+  FILE * file = fdopen(fds[1], "w");
+  if (!file) close(fds[1]);
+  gzip_pid = pid;
+  return file;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Closes the CNF output file and waits for gzip if it is compressed
+
+    @param file FILE * returned by open_cnf_file
+
+    @return true if all data has been written
+*/
+static bool close_cnf_file(FILE * file) {
+  bool ok = !fclose(file);
+  if (!gzip_pid) return ok;
+
+  int status;
+  pid_t pid = gzip_pid;
+  gzip_pid = 0;
+  while (waitpid(pid, &status, 0) < 0)
+    if (errno != EINTR) return 0;
+  return ok && WIFEXITED(status) && !WEXITSTATUS(status);
+}
+
+/*------------------------------------------------------------------------*/
+/** \class Output_closer
+    Closes the output files of substitution that are still open when it
+    goes out of scope, i.e., when an error is thrown before they are closed
+    regularly. The gzip process of the CNF file is reaped as well.
+*/
+class Output_closer {
+  // / CNF and AIG file, 0 once they have been closed regularly
+  FILE *& cnf;
+  FILE *& aig;
+
+ public:
+  /** Constructor
+
+      @param c FILE *& CNF file returned by open_cnf_file or 0
+      @param a FILE *& AIG file or 0
+  */
+  Output_closer(FILE *& c, FILE *& a): cnf(c), aig(a) {}
+
+  Output_closer(const Output_closer &) = delete;
+
+  /** Destructor */
+  ~Output_closer() {
+    if (cnf) close_cnf_file(cnf);
+    if (aig) fclose(aig);
+  }
+};
+
+/*------------------------------------------------------------------------*/
+
 bool substitution(const char * out_f1, const char * out_f2) {
   assert(out_f1);
   assert(out_f2);
 
-  FILE * f1;
-  if (!(f1 = fopen(out_f1, "w")))
+  FILE * f1 = 0, *f2 = 0;
+  Output_closer close_files(f1, f2);
+  if (!(f1 = open_cnf_file(out_f1)))
       die(err_write_file, "can not write output to '%s'", out_f1);
 
-  FILE *f2;
   if (!(f2 = fopen(out_f2, "w")))
       die(err_write_aig, "can not write output to '%s'", out_f2);
 
   init_aig_substitution();
   init_time = process_time();
+  profile_phase("init");
 
-  bool res;
+  bool res, distinguished = 0;
 
   if (identify_final_stage_adder() && build_adder_miter()) {
     res = 1;
 
+    if (miter_simulation) {
+      distinguished = !simulate_miter();
+      if (!distinguished) fraig_miter();
+      profile_phase("miter simulation");
+    }
+
     if (!miter_to_file(f1))
       die(err_write_file, "failed to write miter to '%s'", out_f1);
     else
       msg("writing miter to %s", out_f1);
 
-    generate_rewritten_aig();
-
-    if (!aiger_write_to_file(rewritten, aiger_binary_mode, f2))
-      die(err_write_aig, "failed to write rewritten aig to '%s'", out_f2);
-    else
-      msg("writing rewritten aig to '%s'", out_f2);
+    // the rewritten aig would not be equivalent to the design
+    if (!distinguished) {
+      generate_rewritten_aig();
 
+      if (!aiger_write_to_file(rewritten, aiger_binary_mode, f2))
+        die(err_write_aig, "failed to write rewritten aig to '%s'", out_f2);
+      else
+        msg("writing rewritten aig to '%s'", out_f2);
+    }
 
   } else {
     res = 0;
@@ -70,10 +184,23 @@ bool substitution(const char * out_f1, const char * out_f2) {
   }
 
   substitution_time = process_time();
-
-  fclose(f1);
-  fclose(f2);
+  profile_phase("substitution");
+
+  bool cnf_written = close_cnf_file(f1);
+  bool aig_written = !fclose(f2);
+  f1 = f2 = 0;
+  if (!cnf_written)
+    die(err_write_file, "failed to write '%s'", out_f1);
+  if (!aig_written)
+    die(err_write_aig, "failed to write '%s'", out_f2);
   reset_aig_substitution();
 
+  if (distinguished) {
+    remove(out_f2);
+    die(err_not_equal,
+      "final stage adder is not equivalent to its replacement, "
+      "no rewritten aig written to '%s'", out_f2);
+  }
+
   return res;
 }
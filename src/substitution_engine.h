@@ -9,6 +9,8 @@
 #ifndef AMULET2_SRC_SUBSTITUTION_ENGINE_H_
 #define AMULET2_SRC_SUBSTITUTION_ENGINE_H_
 /*------------------------------------------------------------------------*/
+#include "miter_simulation.h"
+#include "profiler.h"
 #include "substitution.h"
 /*------------------------------------------------------------------------*/
 /**
@@ -22,6 +24,8 @@ void init_gate_substitution();
     Calls the substitution routine.
     We first detect the GP adder, then generate the equivalent miter
     and print the CNF miter and the rewritten AIG to the output files.
+    If simulation of the miter distinguishes the adders, only the miter
+    is written and the run stops with error 53.
 
     @param out_f1 name of first output file
     @param out_f2 name of second output file
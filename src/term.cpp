@@ -89,9 +89,11 @@ bool Term::contains(const Var *v) const {
 
 /*------------------------------------------------------------------------*/
 
-uint64_t size_terms;
-uint64_t current_terms;
-Term ** term_table;
+// Every thread owns its term table, such that gate constraints can be
+// generated concurrently (see 'init_gate_constraints').
+static thread_local uint64_t size_terms;
+static thread_local uint64_t current_terms;
+static thread_local Term ** term_table;
 
 /*------------------------------------------------------------------------*/
 
@@ -170,7 +172,7 @@ void deallocate_term(Term * t) {
 
 /*------------------------------------------------------------------------*/
 
-void deallocate_terms() {
+void clear_terms() {
   for (uint64_t i = 0; i < size_terms; i++) {
     for (Term * m = term_table[i], *n; m; m = n) {
       n = m->get_next();
@@ -179,12 +181,61 @@ void deallocate_terms() {
 
       delete(m);
     }
+    term_table[i] = 0;
   }
+}
+
+/*------------------------------------------------------------------------*/
+
+void deallocate_terms() {
+  clear_terms();
   delete[] term_table;
+  term_table = 0;
+  size_terms = 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+void swap_term_table(Term ** & table, uint64_t & size, uint64_t & current) {
+  std::swap(term_table, table);
+  std::swap(size_terms, size);
+  std::swap(current_terms, current);
+}
+
+/*------------------------------------------------------------------------*/
+
+uint64_t num_terms() { return current_terms; }
+
+/*------------------------------------------------------------------------*/
+
+uint64_t term_table_size() { return size_terms; }
+
+/*------------------------------------------------------------------------*/
+
+std::vector<Term*> detach_terms() {
+  std::vector<Term*> res;
+  res.reserve(current_terms);
+  for (uint64_t i = 0; i < size_terms; i++) {
+    for (Term * m = term_table[i]; m; m = m->get_next()) res.push_back(m);
+  }
+  delete[] term_table;
+  term_table = 0;
+  size_terms = current_terms = 0;
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+Term * import_term(const Term * t) {
+  if (!t) return 0;
+  Term * rest = import_term(t->get_rest());
+  Term * res = new_term(t->get_var(), rest);
+  deallocate_term(rest);
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
-static std::stack<const Var*> vstack;  // /< used to build a term
+static thread_local std::stack<const Var*> vstack;  // /< used to build a term
 /*------------------------------------------------------------------------*/
 
 void add_to_vstack(const Var* v) {
@@ -11,6 +11,7 @@
 #define AMULET2_SRC_TERM_H_
 /*------------------------------------------------------------------------*/
 #include <stack>
+#include <vector>
 
 #include "variable.h"
 /*------------------------------------------------------------------------*/
@@ -198,11 +199,59 @@ Term * new_term(const Var * variable, Term * rest);
 void deallocate_term(Term * t);
 
 
+/**
+    Deletes all terms in the hash table "term_table", but keeps the table
+    allocated such that it can be reused for the next circuit
+*/
+void clear_terms();
+
 /**
     Deallocates the hash table "term_table"
 */
 void deallocate_terms();
 
+/**
+    Empties the term table of the calling thread without deleting the terms.
+    Used to hand over the terms generated by a worker thread.
+
+    @return std::vector<Term*> containing all detached terms
+*/
+std::vector<Term*> detach_terms();
+
+/**
+    Builds the term t in the term table of the calling thread, where t may
+    belong to a term table detached by another thread
+
+    @param t Term*
+
+    @return Term* equal to t, located in the term table of the calling thread
+*/
+Term * import_term(const Term * t);
+
+/**
+    Exchanges the term table of the calling thread with the given one, used
+    to move the terms of a verification context between threads
+
+    @param table Term ** &
+    @param size uint64_t &, number of buckets
+    @param current uint64_t &, number of terms
+*/
+void swap_term_table(Term ** & table, uint64_t & size, uint64_t & current);
+
+/**
+    Returns the number of terms in the term table of the calling thread
+
+    @return uint64_t
+*/
+uint64_t num_terms();
+
+/**
+    Returns the number of buckets of the term table of the calling thread
+
+    @return uint64_t
+*/
+uint64_t term_table_size();
+
 /*------------------------------------------------------------------------*/
 // Terms are generated using a stack "vstack"
 
@@ -0,0 +1,107 @@
+/*------------------------------------------------------------------------*/
+/*! \file trace.cpp
+    \brief timeline of scoped events in the trace event format
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "signal_statistics.h"
+#include "trace.h"
+/*------------------------------------------------------------------------*/
+// Global variable
+const char * trace_name = 0;
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_writing = 201;  // cannot write to
+/*------------------------------------------------------------------------*/
+
+/** \struct Trace_event
+    One complete event of the timeline
+*/
+struct Trace_event {
+  const char * name;  // /< name of the event
+  int slice;          // /< slice, -1 if the event does not belong to a slice
+  int tid;            // /< number of the recording thread
+  double start;       // /< start in microseconds
+  double duration;    // /< duration in microseconds
+};
+
+// / recorded events of all threads, protected by events_mutex
+static std::vector<Trace_event> events;
+static std::mutex events_mutex;
+
+// / number of the last thread that recorded an event
+static std::atomic<int> last_tid(0);
+
+// / number of the calling thread, 0 until it records its first event
+static thread_local int tid = 0;
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Returns the microseconds elapsed since the first call
+
+    @return double
+*/
+static double trace_clock() {
+  typedef std::chrono::steady_clock clock;
+  static const clock::time_point epoch = clock::now();
+  return std::chrono::duration<double, std::micro>(
+    clock::now() - epoch).count();
+}
+
+/*------------------------------------------------------------------------*/
+
+Trace_scope::Trace_scope(const char * _name, int _slice) :
+  name(_name), slice(_slice), start(trace_name ? trace_clock() : 0) { }
+
+/*------------------------------------------------------------------------*/
+
+Trace_scope::~Trace_scope() {
+  if (!trace_name) return;
+  double end = trace_clock();
+  if (!tid) tid = ++last_tid;
+
+  Trace_event e;
+  e.name = name;
+  e.slice = slice;
+  e.tid = tid;
+  e.start = start;
+  e.duration = end - start;
+  std::lock_guard<std::mutex> lock(events_mutex);
+  events.push_back(e);
+}
+
+/*------------------------------------------------------------------------*/
+
+void write_trace() {
+  if (!trace_name) return;
+
+  FILE * file;
+  if (!(file = fopen(trace_name, "w")))
+    die(err_writing, "can not write trace to '%s'", trace_name);
+
+  std::lock_guard<std::mutex> lock(events_mutex);
+  int pid = getpid();
+  fputs("{\"traceEvents\": [\n", file);
+  for (size_t i = 0; i < events.size(); i++) {
+    const Trace_event & e = events[i];
+    fprintf(file, "  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": %i, "
+      "\"tid\": %i, \"ts\": %.3f, \"dur\": %.3f", e.name, pid, e.tid,
+      e.start, e.duration);
+    if (e.slice >= 0) fprintf(file, ", \"args\": {\"slice\": %i}", e.slice);
+    fputs(i+1 < events.size() ? "},\n" : "}\n", file);
+  }
+  fputs("], \"displayTimeUnit\": \"ms\"}\n", file);
+  fclose(file);
+  msg("written %zu trace events to '%s'", events.size(), trace_name);
+}
@@ -0,0 +1,74 @@
+/*------------------------------------------------------------------------*/
+/*! \file trace.h
+    \brief timeline of scoped events in the trace event format
+
+  TRACE_SCOPE(name) records the wall clock time from its definition to the
+  end of the enclosing scope as one complete event, TRACE_SLICE(name, i)
+  additionally stores the slice i. The events of all threads are written
+  to trace_name as JSON in the trace event format, which is read by
+  chrome://tracing, Perfetto and speedscope.
+
+  Tracing is only compiled in with './configure.sh -t', which defines
+  AMULETTRACE. Otherwise both macros expand to nothing.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_TRACE_H_
+#define AMULET2_SRC_TRACE_H_
+/*------------------------------------------------------------------------*/
+// / Name of the trace file, tracing is disabled if 0
+extern const char * trace_name;
+
+/** \class Trace_scope
+    Records one event from its construction to its destruction
+*/
+class Trace_scope {
+  // / name of the event
+  const char * name;
+
+  // / slice of the event, -1 if the event does not belong to a slice
+  int slice;
+
+  // / start of the event in microseconds
+  double start;
+
+ public:
+  /**
+      Constructor
+
+      @param _name const char * name of the event, has to be a literal
+      @param _slice integer slice, -1 if the event does not belong to a
+                    slice
+  */
+  explicit Trace_scope(const char * _name, int _slice = -1);
+
+  /** Destructor, records the event */
+  ~Trace_scope();
+
+  Trace_scope(const Trace_scope &) = delete;
+  Trace_scope & operator=(const Trace_scope &) = delete;
+};
+
+/**
+    Writes all recorded events to trace_name, does nothing if trace_name
+    is 0
+*/
+void write_trace();
+
+/*------------------------------------------------------------------------*/
+#define TRACE_CONCAT_(a, b) a ## b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifdef AMULETTRACE
+#define TRACE_SCOPE(name) \
+  Trace_scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_SLICE(name, i) \
+  Trace_scope TRACE_CONCAT(trace_scope_, __LINE__)(name, i)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_SLICE(name, i)
+#endif
+
+#endif  // AMULET2_SRC_TRACE_H_
@@ -0,0 +1,297 @@
+/*------------------------------------------------------------------------*/
+/*! \file verification_context.cpp
+    \brief reentrant interface to the substitution engine and the
+    polynomial solver
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <mutex>
+#include <utility>
+
+#include "hash_val.h"
+#include "verification_context.h"
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_no_design = 131;  // no design parsed
+/*------------------------------------------------------------------------*/
+
+Verification_options current_options() {
+  Verification_options res;
+  res.signed_mult = signed_mult;
+  res.proof = proof;
+  res.gen_witness = gen_witness;
+  res.max_counter_examples = max_counter_examples;
+  res.simulate = multiplier_simulation;
+  res.num_threads = num_threads;
+  res.verbose = verbose;
+  res.quiet = quiet;
+  res.cache_dir = cache_dir;
+  res.checkpoint = checkpoint_name;
+  res.checkpoint_interval = checkpoint_interval;
+  res.resume = resume_name;
+  res.save_remainders = save_remainders_name;
+  res.incremental = incremental_name;
+  res.spill_memory = spill_memory;
+  res.max_memory = max_memory;
+  res.max_time = max_time;
+  res.progress_interval = progress_interval;
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+// Sets the options of the calling thread
+static void apply_options(const Verification_options & options) {
+  signed_mult = options.signed_mult;
+  proof = options.proof;
+  gen_witness = options.gen_witness;
+  max_counter_examples = options.max_counter_examples;
+  miter_simulation = options.simulate;
+  multiplier_simulation = options.simulate;
+  num_threads = options.num_threads;
+  verbose = options.verbose;
+  quiet = options.quiet;
+  cache_dir = options.cache_dir;
+  checkpoint_name = options.checkpoint;
+  checkpoint_interval = options.checkpoint_interval;
+  resume_name = options.resume;
+  save_remainders_name = options.save_remainders;
+  incremental_name = options.incremental;
+  spill_memory = options.spill_memory;
+  max_memory = options.max_memory;
+  max_time = options.max_time;
+  progress_interval = options.progress_interval;
+}
+
+/*------------------------------------------------------------------------*/
+
+/** \class Verification_context::Binding
+    Binds the state and the options of a context to the calling thread
+    and restores the previous state of the thread on destruction, also
+    if an Amulet_error is thrown
+*/
+class Verification_context::Binding {
+  // / bound context
+  Verification_context * context;
+
+  // / options of the calling thread before binding
+  Verification_options saved_options;
+
+  // / value of throw_errors before binding
+  bool saved_throw_errors;
+
+ public:
+  /**
+      Constructor
+
+      @param _context Verification_context*
+      @param certify bool, proofs are only generated in certify
+  */
+  Binding(Verification_context * _context, bool certify) :
+    context(_context), saved_options(current_options()),
+    saved_throw_errors(throw_errors) {
+    context->swap_state();
+    apply_options(context->options);
+    if (!certify) proof = 0;
+    throw_errors = 1;
+  }
+
+  /**
+      Destructor
+  */
+  ~Binding() {
+    context->swap_state();
+    apply_options(saved_options);
+    throw_errors = saved_throw_errors;
+  }
+};
+
+/*------------------------------------------------------------------------*/
+
+Verification_context::Verification_context(
+  const Verification_options & _options) : options(_options) {
+  static std::once_flag nonces_initialized;
+  std::call_once(nonces_initialized, init_nonces);
+
+  memset(one, 0, sizeof one);
+  memset(minus_one, 0, sizeof minus_one);
+  memset(base, 0, sizeof base);
+  memset(mod_coeff, 0, sizeof mod_coeff);
+}
+
+/*------------------------------------------------------------------------*/
+
+Verification_context::~Verification_context() {
+  Binding binding(this, 0);
+  free_design();
+  deallocate_terms();
+}
+
+/*------------------------------------------------------------------------*/
+
+void Verification_context::swap_state() {
+  std::swap(M, ::M);
+  std::swap(NN, ::NN);
+  std::swap(a0, ::a0);
+  std::swap(al, ::al);
+  std::swap(ainc, ::ainc);
+  std::swap(b0, ::b0);
+  std::swap(bl, ::bl);
+  std::swap(binc, ::binc);
+  aiger * thread_model = get_model();
+  set_model(model);
+  model = thread_model;
+
+  std::swap(gates, ::gates);
+  std::swap(num_gates, ::num_gates);
+  std::swap(const0_gate, ::const0_gate);
+  std::swap(xor_chain, ::xor_chain);
+  std::swap(booth, ::booth);
+  swap_visit_epoch(visit_epoch);
+
+  std::swap(one[0], ::one[0]);
+  std::swap(minus_one[0], ::minus_one[0]);
+  std::swap(base[0], ::base[0]);
+  std::swap(mod_coeff[0], ::mod_coeff[0]);
+
+  swap_term_table(term_table, size_terms, current_terms);
+  std::swap(num_monomials, ::num_monomials);
+  std::swap(num_polynomials, ::num_polynomials);
+}
+
+/*------------------------------------------------------------------------*/
+
+void Verification_context::free_design() {
+  slices.clear();
+  delete_gates();
+  clear_terms();
+  if (coefficients) clear_mpz();
+  coefficients = 0;
+  if (get_model()) reset_aig_parsing();
+  if (miter) reset_aig_substitution();
+  ::xor_chain = 0;
+  ::booth = 0;
+  input_name.clear();
+}
+
+/*------------------------------------------------------------------------*/
+
+void Verification_context::parse(const char * _input_name) {
+  Binding binding(this, 0);
+  free_design();
+  try {
+    parse_aig(_input_name);
+  } catch (const Amulet_error &) {
+    free_design();
+    throw;
+  }
+  input_name = _input_name;
+  profile_phase("parse");
+}
+
+/*------------------------------------------------------------------------*/
+
+void Verification_context::parse(const char * buffer, size_t size) {
+  Binding binding(this, 0);
+  free_design();
+  try {
+    parse_aig_buffer(buffer, size);
+  } catch (const Amulet_error &) {
+    free_design();
+    throw;
+  }
+  profile_phase("parse");
+}
+
+/*------------------------------------------------------------------------*/
+
+void Verification_context::parse(const aiger * aig) {
+  Binding binding(this, 0);
+  free_design();
+  try {
+    parse_aig_copy(aig);
+  } catch (const Amulet_error &) {
+    free_design();
+    throw;
+  }
+  profile_phase("parse");
+}
+
+/*------------------------------------------------------------------------*/
+
+bool Verification_context::verify_design(const char * out_f1,
+    const char * out_f2, const char * out_f3, bool certify) {
+  Binding binding(this, certify);
+  if (!get_model()) die(err_no_design, "no design has been parsed");
+
+  ::counter_examples.clear();
+  counter_examples.clear();
+  input_names.clear();
+
+  bool res;
+  try {
+    init_gates_verify();
+    coefficients = 1;
+    for (unsigned i = 0; i < ::NN; i++)
+      input_names.push_back(::gates[i]->get_var_name());
+    const char * inp_f = input_name.empty() ? 0 : input_name.c_str();
+    if (cache_dir &&
+        lookup_cached_result(inp_f, out_f1, out_f2, out_f3, certify, res)) {
+      init_time = slicing_elim_time = reduction_time = process_time();
+      profile_phase("cache");
+    } else {
+      double start = wall_clock_time();
+      res = ::verify(inp_f, out_f1, out_f2, out_f3, certify);
+      if (cache_dir) store_cached_result(out_f1, out_f2, out_f3, certify,
+                                         res, wall_clock_time() - start);
+    }
+    counter_examples.swap(::counter_examples);
+  } catch (const Amulet_error &) {
+    free_design();
+    throw;
+  }
+  free_design();
+  profile_phase("reset");
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+bool Verification_context::verify() {
+  return verify_design(0, 0, 0, 0);
+}
+
+/*------------------------------------------------------------------------*/
+
+bool Verification_context::certify(
+  const char * out_f1, const char * out_f2, const char * out_f3) {
+  return verify_design(out_f1, out_f2, out_f3, 1);
+}
+
+/*------------------------------------------------------------------------*/
+
+bool Verification_context::substitution(
+  const char * out_f1, const char * out_f2) {
+  Binding binding(this, 0);
+  if (!get_model()) die(err_no_design, "no design has been parsed");
+
+  bool res;
+  try {
+    init_gate_substitution();
+    res = ::substitution(out_f1, out_f2);
+  } catch (const Amulet_error &) {
+    free_design();
+    throw;
+  }
+  free_design();
+  profile_phase("reset");
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+void Verification_context::reset() {
+  Binding binding(this, 0);
+  free_design();
+}
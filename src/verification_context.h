@@ -0,0 +1,244 @@
+/*------------------------------------------------------------------------*/
+/*! \file verification_context.h
+    \brief reentrant interface to the substitution engine and the
+    polynomial solver
+
+  The state of AMulet2 (the AIG, the gates, the slices, the term table and
+  the coefficients) is thread local. A Verification_context owns the state
+  of one design while none of its methods is running and binds it to the
+  calling thread for the duration of a method call. Thus several contexts
+  can verify different designs concurrently on separate threads, and a
+  context can move between threads, as long as it is used by one thread at
+  a time.
+
+  Errors raised inside a method throw an Amulet_error instead of exiting
+  the program, and the design of the context is freed.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#ifndef AMULET2_SRC_VERIFICATION_CONTEXT_H_
+#define AMULET2_SRC_VERIFICATION_CONTEXT_H_
+/*------------------------------------------------------------------------*/
+#include <string>
+#include <vector>
+
+#include "parser.h"
+#include "progress.h"
+#include "checkpoint.h"
+#include "incremental.h"
+#include "polynomial_solver.h"
+#include "resource_limits.h"
+#include "result_cache.h"
+#include "spill.h"
+#include "substitution_engine.h"
+/*------------------------------------------------------------------------*/
+
+/** \struct Verification_options
+    Options of a verification context, as given on the command line
+*/
+struct Verification_options {
+  bool signed_mult = 0;               // /< '-signed'
+  int proof = 2;                      // /< proof format of certify, '-p<n>'
+  bool gen_witness = 1;               // /< false for '-no-counter-examples'
+  unsigned max_counter_examples = 0;  // /< '-counter-examples <n>'
+  bool simulate = 0;                  // /< '-simulate'
+  unsigned num_threads = 1;           // /< '-threads <n>'
+  int verbose = 1;                    // /< '-v<n>'
+  bool quiet = 0;                     // /< suppresses all messages
+  const char * cache_dir = 0;         // /< '-cache <dir>'
+  const char * checkpoint = 0;        // /< '-checkpoint <file>'
+  double checkpoint_interval = 60;    // /< '-checkpoint-interval <seconds>'
+  const char * resume = 0;            // /< '-resume <file>'
+  const char * save_remainders = 0;   // /< '-save-remainders <file>'
+  const char * incremental = 0;       // /< '-incremental <file>'
+  double spill_memory = 0;            // /< '-spill <MB>'
+  double max_memory = 0;              // /< '-max-mem <MB>', process-wide
+  double max_time = 0;                // /< '-max-time <seconds>'
+  double progress_interval = 0;       // /< '-progress <seconds>'
+};
+
+/**
+    Returns the options currently set on the calling thread, i.e., the
+    options parsed from the command line
+
+    @return Verification_options
+*/
+Verification_options current_options();
+
+/*------------------------------------------------------------------------*/
+
+/** \class Verification_context
+    Owns the state of one design and provides the modes of AMulet2
+*/
+class Verification_context {
+  // / name of the parsed input file, used for counter examples, empty if
+  // / the design has been given in memory
+  std::string input_name;
+
+  // / counter examples found by the last verification
+  std::vector<std::vector<bool>> counter_examples;
+
+  // / names of the inputs of the last verified design
+  std::vector<std::string> input_names;
+
+  // / true if the coefficients have been initialized
+  bool coefficients = 0;
+
+  // / Variables of the aig module
+  unsigned M = 0, NN = 0;
+  unsigned a0 = 0, al = 0, ainc = 0;
+  unsigned b0 = 0, bl = 0, binc = 0;
+  aiger * model = 0;
+
+  // / Variables of the gate module
+  Gate ** gates = 0;
+  unsigned num_gates = 0;
+  Gate * const0_gate = 0;
+  bool xor_chain = 0, booth = 0;
+  unsigned visit_epoch = 0;
+
+  // / Coefficients
+  mpz_t one, minus_one, base, mod_coeff;
+
+  // / Term table and counters of the polynomial module
+  Term ** term_table = 0;
+  uint64_t size_terms = 0, current_terms = 0;
+  int64_t num_monomials = 0, num_polynomials = 0;
+
+  class Binding;
+
+  /**
+      Exchanges the state of the context with the state of the calling
+      thread
+  */
+  void swap_state();
+
+  /**
+      Frees the design of the bound context, keeps the term table
+  */
+  void free_design();
+
+  /**
+      Verifies the parsed design, writing the proof if certify is true
+
+      @param out_f1 name of the gate constraints file
+      @param out_f2 name of the proof file
+      @param out_f3 name of the specification file
+      @param certify bool
+
+      @return true if the multiplier is correct
+  */
+  bool verify_design(const char * out_f1, const char * out_f2,
+                     const char * out_f3, bool certify);
+
+ public:
+  // / options used by the methods of the context
+  Verification_options options;
+
+  /**
+      Constructor
+
+      @param _options const Verification_options &
+  */
+  explicit Verification_context(
+    const Verification_options & _options = Verification_options());
+
+  /**
+      Destructor, frees the design and the term table
+  */
+  ~Verification_context();
+
+  Verification_context(const Verification_context &) = delete;
+  Verification_context & operator=(const Verification_context &) = delete;
+
+  /**
+      Reads the AIG from the file, replacing a previously parsed design
+
+      @param _input_name char * name of the input file
+  */
+  void parse(const char * _input_name);
+
+  /**
+      Reads the AIG in AIGER format from a memory buffer, replacing a
+      previously parsed design. No counter example file is written for
+      the design.
+
+      @param buffer const char* contents of an AIGER file
+      @param size size_t number of bytes in buffer
+  */
+  void parse(const char * buffer, size_t size);
+
+  /**
+      Copies the AIG, replacing a previously parsed design. No counter
+      example file is written for the design.
+
+      @param aig const aiger*, which is not modified
+  */
+  void parse(const aiger * aig);
+
+  /**
+      Returns whether a design has been parsed and not yet consumed
+
+      @return bool
+  */
+  bool is_parsed() const { return model; }
+
+  /**
+      Verifies the parsed design as in '-verify', consumes the design
+
+      @return true if the multiplier is correct
+  */
+  bool verify();
+
+  /**
+      Verifies the parsed design and writes the certificate as in
+      '-certify', consumes the design
+
+      @param out_f1 name of the gate constraints file
+      @param out_f2 name of the proof file
+      @param out_f3 name of the specification file
+
+      @return true if the multiplier is correct
+  */
+  bool certify(const char * out_f1, const char * out_f2, const char * out_f3);
+
+  /**
+      Substitutes the final stage adder of the parsed design as in
+      '-substitute', consumes the design
+
+      @param out_f1 name of the CNF miter file
+      @param out_f2 name of the rewritten AIG file
+
+      @return true if the adder has been substituted
+  */
+  bool substitution(const char * out_f1, const char * out_f2);
+
+  /**
+      Returns the counter examples found by the last call of verify or
+      certify, each ordered as the inputs of the AIG
+
+      @return const std::vector<std::vector<bool>> &
+  */
+  const std::vector<std::vector<bool>> & get_counter_examples() const {
+    return counter_examples;
+  }
+
+  /**
+      Returns the names of the inputs of the design of the last call of
+      verify or certify
+
+      @return const std::vector<std::string> &
+  */
+  const std::vector<std::string> & get_input_names() const {
+    return input_names;
+  }
+
+  /**
+      Frees the parsed design
+  */
+  void reset();
+};
+
+#endif  // AMULET2_SRC_VERIFICATION_CONTEXT_H_
@@ -0,0 +1,695 @@
+/*------------------------------------------------------------------------*/
+/*! \file genmul.cpp
+    \brief generator of multiplier AIGs for benchmarking AMulet2
+
+  Generates n-bit times n-bit multipliers with 2n outputs, built from a
+  partial product generator (simple or radix-4 booth recoding), an
+  accumulation of the partial products (array, Wallace or Dadda tree) and
+  a final stage adder (ripple carry, carry-lookahead or Kogge-Stone), for
+  unsigned and signed integers. The inputs are ordered as in the ABC
+  generated and AOKI benchmarks(a[0..n-1], b[0..n-1]) or as in the BTOR
+  generated benchmarks(a[0], b[0], a[1], b[1], ...), which are the two
+  orderings determine_input_order of AMulet2 recognizes.
+
+  Negative weights of signed partial products and of the sign bits of booth
+  rows are replaced by the negated bit and a constant correction, i.e.,
+  -x*2^i = (~x - 1)*2^i, the constants are summed up modulo 2^(2n) and
+  added as one further row of constant bits.
+
+  The gates have the shapes AMulet2 expects from the AOKI benchmarks. In
+  particular an XOR is ~(~(a & ~b) & ~(~a & b)), thus the and gate a & b of
+  a carry is not an internal gate of the XOR. Ripple carry designs are
+  verified directly, carry-lookahead and Kogge-Stone adders are replaced by
+  '-substitute' first, which fails for signed booth multipliers with Dadda
+  accumulation of even width and for booth multipliers below 6 bits.
+
+  Part of AMulet2 : AIG Multiplier Verification Tool.
+  Copyright(C) 2020, 2021 Daniela Kaufmann, Johannes Kepler University Linz
+*/
+/*------------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+extern "C" {
+  #include "../includes/aiger.h"
+}
+/*------------------------------------------------------------------------*/
+// / Manual of genmul, will be printed with command line '-h'
+static const char * USAGE =
+"\n"
+"### USAGE ###\n"
+"usage : genmul [<option> ...] <n> <output.aig|output.aag>\n"
+"\n"
+"    generates an n-bit times n-bit multiplier with 2n outputs, written in\n"
+"    binary(*.aig) or ASCII(*.aag) AIGER format, gzipped for *.gz\n"
+"\n"
+"    <option> = the following options are available \n"
+"      -h | --help       print this command line summary \n"
+"      -signed           multiplier for signed integers(default unsigned)\n"
+"      -btor             interleaved inputs a[0], b[0], a[1], ... as in BTOR\n"
+"                        generated benchmarks(default a[0..n-1], b[0..n-1])\n"
+"\n"
+"      -simple           simple partial products a[i] & b[j](default)\n"
+"      -booth            radix-4 booth recoded partial products\n"
+"\n"
+"      -array            carry-save array accumulation(default)\n"
+"      -wallace          Wallace tree accumulation\n"
+"      -dadda            Dadda tree accumulation\n"
+"\n"
+"      -ripple           ripple carry final stage adder(default)\n"
+"      -cla              carry-lookahead final stage adder(4-bit blocks)\n"
+"      -kogge-stone      Kogge-Stone final stage adder\n"
+"\n"
+"    ripple carry designs are verified by 'amulet -verify', the other final\n"
+"    stage adders are replaced by 'amulet -substitute' first\n";
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_wrong_arg = 1;  // wrong arguments given
+static int err_writing   = 2;  // cannot write to
+/*------------------------------------------------------------------------*/
+
+/**
+    Prints an error message to stderr and exits the program
+
+    @param error_code integer
+    @param fmt char* message
+*/
+static void die(int error_code, const char * fmt, ...) {
+  va_list ap;
+  fprintf(stderr, "*** [genmul] error code %i \n", error_code);
+  fputs("*** [genmul] ", stderr);
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+  va_end(ap);
+  fputc('\n', stderr);
+  exit(error_code);
+}
+
+/*------------------------------------------------------------------------*/
+// AIG with structural hashing and constant propagation, literals follow
+// the AIGER convention: 0 is false, 1 is true and 2v+1 negates 2v
+
+// / number of inputs, the inputs are the variables 1, ..., num_inputs
+static unsigned num_inputs;
+
+// / and gates as pairs of children, the i-th gate is variable num_inputs+1+i
+static std::vector<std::pair<unsigned, unsigned>> ands;
+
+// / unique table of the and gates
+static std::unordered_map<uint64_t, unsigned> and_table;
+
+/**
+    Returns the literal of the conjunction of a and b
+
+    @param a unsigned literal
+    @param b unsigned literal
+
+    @return unsigned literal
+*/
+static unsigned aig_and(unsigned a, unsigned b) {
+  if (a > b) std::swap(a, b);
+  if (a == 0) return 0;
+  if (a == 1) return b;
+  if (a == b) return a;
+  if ((a ^ 1) == b) return 0;
+
+  uint64_t key = (static_cast<uint64_t>(b) << 32) | a;
+  std::unordered_map<uint64_t, unsigned>::const_iterator it =
+    and_table.find(key);
+  if (it != and_table.end()) return it->second;
+
+  unsigned lit = 2 * (num_inputs + 1 + ands.size());
+  ands.push_back(std::make_pair(b, a));
+  and_table[key] = lit;
+  return lit;
+}
+
+/*------------------------------------------------------------------------*/
+
+static unsigned aig_or(unsigned a, unsigned b) {
+  return aig_and(a ^ 1, b ^ 1) ^ 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+static unsigned aig_xor(unsigned a, unsigned b) {
+  return aig_and(aig_and(a, b ^ 1) ^ 1, aig_and(a ^ 1, b) ^ 1) ^ 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Half adder
+
+    @param a unsigned literal
+    @param b unsigned literal
+    @param carry unsigned &, literal of the carry output
+
+    @return unsigned literal of the sum output
+*/
+static unsigned half_adder(unsigned a, unsigned b, unsigned & carry) {
+  carry = aig_and(a, b);
+  return aig_xor(a, b);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Full adder
+
+    @param a unsigned literal
+    @param b unsigned literal
+    @param c unsigned literal
+    @param carry unsigned &, literal of the carry output
+
+    @return unsigned literal of the sum output
+*/
+static unsigned full_adder(
+  unsigned a, unsigned b, unsigned c, unsigned & carry) {
+  unsigned t = aig_xor(a, b);
+  carry = aig_or(aig_and(a, b), aig_and(t, c));
+  return aig_xor(t, c);
+}
+
+/*------------------------------------------------------------------------*/
+// Options and inputs
+
+// / width of the inputs
+static unsigned n;
+
+// / selected architecture
+static bool is_signed, btor_order, booth;
+static const char * accumulation = "array";
+static const char * final_adder = "ripple";
+
+// / literals of the inputs a[i] and b[i]
+static std::vector<unsigned> a, b;
+
+/**
+    Returns a[i] extended to indices outside of 0, ..., n-1, i.e., 0 below
+    and 0 or the sign a[n-1] above
+
+    @param i integer
+
+    @return unsigned literal
+*/
+static unsigned a_bit(int i) {
+  if (i < 0) return 0;
+  if (i >= static_cast<int>(n)) return is_signed ? a[n-1] : 0;
+  return a[i];
+}
+
+static unsigned b_bit(int i) {
+  if (i < 0) return 0;
+  if (i >= static_cast<int>(n)) return is_signed ? b[n-1] : 0;
+  return b[i];
+}
+
+/*------------------------------------------------------------------------*/
+// Partial products, collected as columns of bits of the same weight
+
+// / bits of weight 2^i, only weights below 2^(2n) are kept
+static std::vector<std::vector<unsigned>> columns;
+
+// / rows of partial products used by the array accumulation, the order of
+// / the rows of single bits(constants and booth negation bits) matters
+static std::vector<std::vector<unsigned>> rows;
+
+// / row to which add_bit adds
+static size_t current_row;
+
+// / sum of the constant corrections modulo 2^(2n), one bit per column
+static std::vector<bool> correction;
+
+/**
+    Adds bit x with weight 2^i to the row current_row
+
+    @param i unsigned column
+    @param x unsigned literal
+*/
+static void add_bit(unsigned i, unsigned x) {
+  if (i >= 2*n || x == 0) return;
+  rows[current_row][i] = x;
+}
+
+/**
+    Adds bit x with weight -2^i to the row current_row
+
+    @param i unsigned column
+    @param x unsigned literal
+*/
+static void sub_bit(unsigned i, unsigned x) {
+  if (i >= 2*n || x == 0) return;
+  add_bit(i, x ^ 1);
+  // subtract 2^i from the correction
+  while (i < 2*n) {
+    correction[i] = !correction[i];
+    if (correction[i++] == 0) break;
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Starts a new row of partial products
+
+    @param first bool, inserts the row before all other rows
+*/
+static void new_row(bool first = false) {
+  if (first) {
+    rows.insert(rows.begin(), std::vector<unsigned>(2*n, 0));
+    current_row = 0;
+  } else {
+    rows.push_back(std::vector<unsigned>(2*n, 0));
+    current_row = rows.size() - 1;
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Generates the partial products a[i] & b[j], for signed multipliers the
+    products with exactly one sign bit have negative weight(Baugh-Wooley)
+*/
+static void simple_partial_products() {
+  for (unsigned i = 0; i < n; i++) {
+    new_row();
+    for (unsigned j = 0; j < n; j++) {
+      unsigned pp = aig_and(a[i], b[j]);
+      if (is_signed && (i == n-1) != (j == n-1)) sub_bit(i+j, pp);
+      else
+        add_bit(i+j, pp);
+    }
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Generates the rows d[k]*a*4^k of the radix-4 booth recoding of b, where
+    the digit d[k] = -2b[2k+1] + b[2k] + b[2k-1] is in {-2, ..., 2}. Each row
+    is an (n+2)-bit two's complement number, or an (n+1)-bit one for signed
+    multipliers, a negative row is the inverted magnitude plus one in column
+    2k. The plus ones are collected in one row.
+*/
+static void booth_partial_products() {
+  unsigned digits = is_signed ? (n+1)/2 : n/2 + 1;
+  unsigned sign = is_signed ? n : n+1;
+  new_row();
+  size_t neg_row = current_row;
+  for (unsigned k = 0; k < digits; k++) {
+    unsigned x2 = b_bit(2*k+1), x1 = b_bit(2*k);
+    unsigned x0 = b_bit(static_cast<int>(2*k) - 1);
+    unsigned one = aig_xor(x1, x0);
+    unsigned two = aig_or(
+      aig_and(x2, aig_and(x1 ^ 1, x0 ^ 1)),
+      aig_and(x2 ^ 1, aig_and(x1, x0)));
+    unsigned neg = aig_and(x2, aig_and(x1, x0) ^ 1);
+
+    new_row();
+    unsigned first_carry = 0;
+    for (unsigned j = 0; j <= sign; j++) {
+      unsigned mag = aig_or(aig_and(one, a_bit(j)),
+        aig_and(two, a_bit(static_cast<int>(j) - 1)));
+      if (k == 0 && j == 0) {
+        // the least significant bit of the product is mag = a[0] & b[0],
+        // only the carry neg & ~mag of adding (mag ^ neg) and neg is kept,
+        // written without mag such that s[0] has no further parent
+        add_bit(0, mag);
+        first_carry = aig_or(aig_and(neg, one ^ 1),
+          aig_and(aig_and(neg, one), a[0] ^ 1));
+        continue;
+      }
+      unsigned pp = aig_xor(mag, neg);
+      if (j == sign) sub_bit(2*k+j, pp);
+      else
+        add_bit(2*k+j, pp);
+    }
+    current_row = neg_row;
+    if (k == 0) add_bit(1, first_carry);
+    else
+      add_bit(2*k, neg);
+  }
+}
+
+/*------------------------------------------------------------------------*/
+// Accumulation of the partial products to two rows x and y
+
+/**
+    Adds the constant correction as a row of its own. For simple partial
+    products it is the first row, thus the array accumulation adds the
+    constants before the partial products and not in its last adders, which
+    would hide the final stage adder. For booth partial products it is the
+    last row, otherwise adding a constant to the single partial product of
+    a high column passes that partial product on as carry into the final
+    stage adder.
+*/
+static void add_correction_row() {
+  new_row(!booth);
+  for (unsigned i = 0; i < 2*n; i++)
+    if (correction[i]) add_bit(i, 1);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Carry-save array, adds one row after the other to a sum and a carry row
+
+    @param x std::vector<unsigned> &, first resulting row
+    @param y std::vector<unsigned> &, second resulting row
+*/
+static void array_accumulation(
+  std::vector<unsigned> & x, std::vector<unsigned> & y) {
+  std::vector<unsigned> sum(2*n, 0), carry(2*n, 0);
+  for (size_t r = 0; r < rows.size(); r++) {
+    std::vector<unsigned> next(2*n, 0);
+    for (unsigned i = 0; i < 2*n; i++) {
+      unsigned c;
+      sum[i] = full_adder(sum[i], carry[i], rows[r][i], c);
+      if (i+1 < 2*n) next[i+1] = c;
+    }
+    carry = next;
+  }
+  x = sum;
+  y = carry;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Moves all non-constant-zero bits of the rows into the columns
+*/
+static void fill_columns() {
+  columns.assign(2*n, std::vector<unsigned>());
+  for (size_t r = 0; r < rows.size(); r++)
+    for (unsigned i = 0; i < 2*n; i++)
+      if (rows[r][i]) columns[i].push_back(rows[r][i]);
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Returns the maximal number of bits in a column
+
+    @return size_t
+*/
+static size_t max_height() {
+  size_t h = 0;
+  for (unsigned i = 0; i < 2*n; i++)
+    if (columns[i].size() > h) h = columns[i].size();
+  return h;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Wallace tree, in each layer every three bits of a column are reduced by
+    a full adder and two remaining bits by a half adder
+*/
+static void wallace_accumulation() {
+  fill_columns();
+  while (max_height() > 2) {
+    std::vector<std::vector<unsigned>> next(2*n);
+    for (unsigned i = 0; i < 2*n; i++) {
+      const std::vector<unsigned> & col = columns[i];
+      size_t j = 0;
+      unsigned c;
+      for (; j + 3 <= col.size(); j += 3) {
+        next[i].push_back(full_adder(col[j], col[j+1], col[j+2], c));
+        if (i+1 < 2*n) next[i+1].push_back(c);
+      }
+      if (j + 2 == col.size()) {
+        next[i].push_back(half_adder(col[j], col[j+1], c));
+        if (i+1 < 2*n) next[i+1].push_back(c);
+      } else if (j + 1 == col.size()) {
+        next[i].push_back(col[j]);
+      }
+    }
+    columns = next;
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Dadda tree, reduces the column heights in each stage to the next smaller
+    number of the sequence 2, 3, 4, 6, 9, 13, ... with as few adders as
+    possible
+*/
+static void dadda_accumulation() {
+  fill_columns();
+  std::vector<size_t> heights(1, 2);
+  while (heights.back() < max_height())
+    heights.push_back(heights.back() * 3 / 2);
+
+  for (size_t s = heights.size() - 1; s-- > 0; ) {
+    size_t d = heights[s];
+    for (unsigned i = 0; i < 2*n; i++) {
+      std::vector<unsigned> & col = columns[i];
+      size_t j = 0;
+      std::vector<unsigned> out;
+      unsigned c;
+      while (col.size() - j + out.size() > d && col.size() - j >= 2) {
+        if (col.size() - j + out.size() == d + 1 || col.size() - j == 2) {
+          out.push_back(half_adder(col[j], col[j+1], c));
+          j += 2;
+        } else {
+          out.push_back(full_adder(col[j], col[j+1], col[j+2], c));
+          j += 3;
+        }
+        if (i+1 < 2*n) columns[i+1].push_back(c);
+      }
+      out.insert(out.end(), col.begin() + j, col.end());
+      col = out;
+    }
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Splits the columns of height at most two in two rows
+
+    @param x std::vector<unsigned> &, first resulting row
+    @param y std::vector<unsigned> &, second resulting row
+*/
+static void columns_to_rows(
+  std::vector<unsigned> & x, std::vector<unsigned> & y) {
+  x.assign(2*n, 0);
+  y.assign(2*n, 0);
+  for (unsigned i = 0; i < 2*n; i++) {
+    if (columns[i].size() > 0) x[i] = columns[i][0];
+    if (columns[i].size() > 1) y[i] = columns[i][1];
+  }
+}
+
+/*------------------------------------------------------------------------*/
+// Final stage adders, return the sum of x and y modulo 2^(2n)
+
+static std::vector<unsigned> ripple_carry_adder(
+  const std::vector<unsigned> & x, const std::vector<unsigned> & y) {
+  std::vector<unsigned> s(2*n);
+  unsigned c = 0;
+  for (unsigned i = 0; i < 2*n; i++)
+    s[i] = full_adder(x[i], y[i], c, c);
+  return s;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Carry-lookahead adder with blocks of four bits, the carries inside a
+    block are computed from the generate and propagate signals and the
+    carry into the block, the carries between the blocks ripple
+
+    @param x const std::vector<unsigned> &
+    @param y const std::vector<unsigned> &
+
+    @return std::vector<unsigned> sum
+*/
+static std::vector<unsigned> carry_lookahead_adder(
+  const std::vector<unsigned> & x, const std::vector<unsigned> & y) {
+  std::vector<unsigned> g(2*n), p(2*n), s(2*n);
+  for (unsigned i = 0; i < 2*n; i++) {
+    g[i] = aig_and(x[i], y[i]);
+    p[i] = aig_xor(x[i], y[i]);
+  }
+  unsigned cin = 0;
+  for (unsigned base = 0; base < 2*n; base += 4) {
+    unsigned end = base + 4 < 2*n ? base + 4 : 2*n;
+    for (unsigned i = base; i <= end && i < 2*n; i++) {
+      // c[i] = g[i-1] | p[i-1] g[i-2] | ... | p[i-1] ... p[base] cin
+      unsigned c = 0, prop = 1;
+      for (unsigned j = i; j-- > base; ) {
+        c = aig_or(c, aig_and(prop, g[j]));
+        prop = aig_and(prop, p[j]);
+      }
+      c = aig_or(c, aig_and(prop, cin));
+      if (i == end) cin = c;
+      else
+        s[i] = aig_xor(p[i], c);
+    }
+  }
+  return s;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Kogge-Stone adder, computes the group generate and propagate signals of
+    all prefixes in log(2n) levels
+
+    @param x const std::vector<unsigned> &
+    @param y const std::vector<unsigned> &
+
+    @return std::vector<unsigned> sum
+*/
+static std::vector<unsigned> kogge_stone_adder(
+  const std::vector<unsigned> & x, const std::vector<unsigned> & y) {
+  std::vector<unsigned> g(2*n), p(2*n), s(2*n);
+  for (unsigned i = 0; i < 2*n; i++) {
+    g[i] = aig_and(x[i], y[i]);
+    p[i] = aig_xor(x[i], y[i]);
+  }
+  std::vector<unsigned> gg = g, pp = p;
+  for (unsigned dist = 1; dist < 2*n; dist *= 2) {
+    std::vector<unsigned> ng = gg, np = pp;
+    for (unsigned i = dist; i < 2*n; i++) {
+      ng[i] = aig_or(gg[i], aig_and(pp[i], gg[i-dist]));
+      np[i] = aig_and(pp[i], pp[i-dist]);
+    }
+    gg = ng;
+    pp = np;
+  }
+  s[0] = p[0];
+  for (unsigned i = 1; i < 2*n; i++) s[i] = aig_xor(p[i], gg[i-1]);
+  return s;
+}
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Writes the cone of influence of the outputs to file_name, the and gates
+    are renumbered in the order of their generation
+
+    @param s const std::vector<unsigned> &, outputs
+    @param file_name const char *
+*/
+static void write_multiplier(
+  const std::vector<unsigned> & s, const char * file_name) {
+  std::vector<bool> used(ands.size(), false);
+  for (unsigned i = 0; i < 2*n; i++)
+    if (s[i]/2 > num_inputs) used[s[i]/2 - num_inputs - 1] = true;
+  for (size_t i = ands.size(); i-- > 0; ) {
+    if (!used[i]) continue;
+    unsigned l = ands[i].first / 2, r = ands[i].second / 2;
+    if (l > num_inputs) used[l - num_inputs - 1] = true;
+    if (r > num_inputs) used[r - num_inputs - 1] = true;
+  }
+
+  std::vector<unsigned> var(num_inputs + 1 + ands.size());
+  for (unsigned i = 0; i <= num_inputs; i++) var[i] = i;
+  unsigned next = num_inputs + 1;
+  for (size_t i = 0; i < ands.size(); i++)
+    if (used[i]) var[num_inputs + 1 + i] = next++;
+
+  aiger * aig = aiger_init();
+  std::string name;
+  for (unsigned i = 0; i < num_inputs; i++) {
+    bool is_a = btor_order ? !(i & 1) : i < n;
+    unsigned idx = btor_order ? i/2 : i % n;
+    name = std::string(is_a ? "a[" : "b[") + std::to_string(idx) + "]";
+    aiger_add_input(aig, 2*(i+1), name.c_str());
+  }
+  for (size_t i = 0; i < ands.size(); i++) {
+    if (!used[i]) continue;
+    unsigned l = ands[i].first, r = ands[i].second;
+    aiger_add_and(aig, 2*var[num_inputs + 1 + i],
+      2*var[l/2] + (l & 1), 2*var[r/2] + (r & 1));
+  }
+  for (unsigned i = 0; i < 2*n; i++) {
+    name = "s[" + std::to_string(i) + "]";
+    aiger_add_output(aig, 2*var[s[i]/2] + (s[i] & 1), name.c_str());
+  }
+
+  if (!aiger_open_and_write_to_file(aig, file_name))
+    die(err_writing, "can not write multiplier to '%s'", file_name);
+  printf("[genmul] written %u-bit multiplier with %u and gates to '%s'\n",
+    n, next - num_inputs - 1, file_name);
+  aiger_reset(aig);
+}
+
+/*------------------------------------------------------------------------*/
+
+int main(int argc, char ** argv) {
+  const char * output_name = 0;
+  bool width_given = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+      fputs(USAGE, stdout);
+      return 0;
+    } else if (!strcmp(argv[i], "-signed")) { is_signed = true;
+    } else if (!strcmp(argv[i], "-btor")) { btor_order = true;
+    } else if (!strcmp(argv[i], "-simple")) { booth = false;
+    } else if (!strcmp(argv[i], "-booth")) { booth = true;
+    } else if (!strcmp(argv[i], "-array") || !strcmp(argv[i], "-wallace") ||
+               !strcmp(argv[i], "-dadda")) { accumulation = argv[i] + 1;
+    } else if (!strcmp(argv[i], "-ripple") || !strcmp(argv[i], "-cla") ||
+               !strcmp(argv[i], "-kogge-stone")) { final_adder = argv[i] + 1;
+    } else if (argv[i][0] == '-' && argv[i][1]) {
+      die(err_wrong_arg, "invalid option '%s'(try '-h')", argv[i]);
+    } else if (!width_given) {
+      int w = atoi(argv[i]);
+      if (w < 2) die(err_wrong_arg, "width '%s' is not at least 2", argv[i]);
+      n = w;
+      width_given = true;
+    } else if (!output_name) {
+      output_name = argv[i];
+    } else {
+      die(err_wrong_arg, "too many arguments(try '-h')");
+    }
+  }
+  if (!output_name) die(err_wrong_arg, "too few arguments(try '-h')");
+
+  num_inputs = 2*n;
+  for (unsigned i = 0; i < n; i++) {
+    a.push_back(btor_order ? 2*(2*i+1) : 2*(i+1));
+    b.push_back(btor_order ? 2*(2*i+2) : 2*(n+i+1));
+  }
+  correction.assign(2*n, false);
+
+  if (booth) booth_partial_products();
+  else
+    simple_partial_products();
+  add_correction_row();
+
+  std::vector<unsigned> x, y;
+  if (!strcmp(accumulation, "array")) {
+    array_accumulation(x, y);
+  } else {
+    if (!strcmp(accumulation, "wallace")) wallace_accumulation();
+    else
+      dadda_accumulation();
+    columns_to_rows(x, y);
+  }
+
+  std::vector<unsigned> s;
+  if (!strcmp(final_adder, "ripple")) s = ripple_carry_adder(x, y);
+  else if (!strcmp(final_adder, "cla")) s = carry_lookahead_adder(x, y);
+  else
+    s = kogge_stone_adder(x, y);
+
+  // the least significant bit is a[0] & b[0], which is also how AMulet2
+  // recognizes the BTOR input ordering
+  s[0] = aig_and(a[0], b[0]);
+
+  write_multiplier(s, output_name);
+  return 0;
+}